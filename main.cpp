@@ -10,9 +10,16 @@ int main(int argc, char **argv) {
 	bool verbose;
 	bool pvp;
 	std::string fen;
+	int hashSize;
+	SearchLimits limits;
+	SearchFeatures features;
+	int threads;
+	enumSearchMode searchMode;
+	int perftDepth;
+	bool divide;
 
 	// Parse arguments and initialize variables
-	argumentParser(argc, argv, level, enginePieces, verbose, fen, pvp);
+	argumentParser(argc, argv, level, enginePieces, verbose, fen, pvp, hashSize, limits, features, threads, searchMode, perftDepth, divide);
 
 	// Construct engine
 	Engine engine(enginePieces, level, verbose, pvp);
@@ -20,6 +27,18 @@ int main(int argc, char **argv) {
 	if (!fen.empty())
 		engine = Engine(fen, enginePieces, level, verbose, pvp);
 
+	engine.setHashSize(hashSize);
+	engine.setLimits(limits);
+	engine.setFeatures(features);
+	engine.setThreads(threads);
+	engine.setSearchMode(searchMode);
+
+	// Test the move generator instead of playing
+	if (perftDepth > 0) {
+		engine.perft(perftDepth, divide);
+		return 0;
+	}
+
 	// Call engine's parser to start interaction
 	engine.parser();
 
@@ -0,0 +1,130 @@
+#ifndef CHESSQDL_ATTACKS_HPP
+#define CHESSQDL_ATTACKS_HPP
+
+#include "const.hpp"
+
+#include <array>
+
+namespace chessqdl {
+
+	/**
+	 * @brief Computes the squares reached from \p idx by each of the \p n steps given as {file, rank} offsets, ignoring the steps that leave the board
+	 * @param idx  index of the origin square
+	 * @param steps  offsets of the piece
+	 * @param n  number of offsets
+	 * @return Bitboard with the reachable squares
+	 */
+	constexpr U64 stepAttacks(int idx, const int steps[][2], int n) {
+		U64 attacks;
+
+		for (int i = 0; i < n; i++) {
+			int file = idx % 8 + steps[i][0];
+			int rank = idx / 8 + steps[i][1];
+
+			if (file >= 0 && file < 8 && rank >= 0 && rank < 8)
+				attacks.set(rank * 8 + file);
+		}
+
+		return attacks;
+	}
+
+
+	/**
+	 * @brief Builds a table with the attacks of a non-sliding piece on every square
+	 */
+	constexpr std::array<U64, 64> makeAttackTable(const int steps[][2], int n) {
+		std::array<U64, 64> table{};
+
+		for (int idx = 0; idx < 64; idx++)
+			table[idx] = stepAttacks(idx, steps, n);
+
+		return table;
+	}
+
+
+	/**
+	 * @brief Builds a table with the squares strictly between every pair of squares that share a rank, file or diagonal. The entry is empty when the squares are not aligned
+	 */
+	constexpr std::array<std::array<U64, 64>, 64> makeBetweenTable() {
+		std::array<std::array<U64, 64>, 64> table{};
+
+		for (int from = 0; from < 64; from++) {
+			for (int df = -1; df <= 1; df++) {
+				for (int dr = -1; dr <= 1; dr++) {
+					U64 ray;
+
+					for (int file = from % 8 + df, rank = from / 8 + dr; (df || dr) && file >= 0 && file < 8 && rank >= 0 && rank < 8; file += df, rank += dr) {
+						table[from][rank * 8 + file] = ray;
+						ray.set(rank * 8 + file);
+					}
+				}
+			}
+		}
+
+		return table;
+	}
+
+
+	/**
+	 * @brief Builds a table with the whole line (edge to edge) that goes through every pair of aligned squares. The entry is empty when the squares are not aligned
+	 */
+	constexpr std::array<std::array<U64, 64>, 64> makeLineTable() {
+		std::array<std::array<U64, 64>, 64> table{};
+
+		for (int from = 0; from < 64; from++) {
+			for (int df = -1; df <= 1; df++) {
+				for (int dr = -1; dr <= 1; dr++) {
+					if (!df && !dr)
+						continue;
+
+					U64 line;
+					line.set(from);
+
+					// Walks both ways to build the line, then assigns it to the squares in the direction (df, dr)
+					for (int sign = -1; sign <= 1; sign += 2)
+						for (int file = from % 8 + sign * df, rank = from / 8 + sign * dr; file >= 0 && file < 8 && rank >= 0 && rank < 8; file += sign * df, rank += sign * dr)
+							line.set(rank * 8 + file);
+
+					for (int file = from % 8 + df, rank = from / 8 + dr; file >= 0 && file < 8 && rank >= 0 && rank < 8; file += df, rank += dr)
+						table[from][rank * 8 + file] = line;
+				}
+			}
+		}
+
+		return table;
+	}
+
+
+	constexpr int knightSteps[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+	constexpr int kingSteps[8][2] = {{0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1}, {-1, -1}, {-1, 0}, {-1, 1}};
+	constexpr int pawnSteps[2][2][2] = {{{-1, 1}, {1, 1}}, {{-1, -1}, {1, -1}}};
+
+
+	/**
+	 * @brief Squares attacked by a knight on each square. Computed at compile time
+	 */
+	inline constexpr std::array<U64, 64> knightAttacks = makeAttackTable(knightSteps, 8);
+
+	/**
+	 * @brief Squares attacked by a king on each square. Computed at compile time
+	 */
+	inline constexpr std::array<U64, 64> kingAttacks = makeAttackTable(kingSteps, 8);
+
+	/**
+	 * @brief Squares attacked by a pawn on each square, indexed by color (nWhite or nBlack) and square. Computed at compile time
+	 */
+	inline constexpr std::array<std::array<U64, 64>, 2> pawnAttacks = {makeAttackTable(pawnSteps[nWhite], 2), makeAttackTable(pawnSteps[nBlack], 2)};
+
+	/**
+	 * @brief Squares strictly between two squares on the same rank, file or diagonal, indexed by both squares. Used to find pins and the squares that block a check
+	 */
+	inline constexpr std::array<std::array<U64, 64>, 64> betweenSquares = makeBetweenTable();
+
+	/**
+	 * @brief Full line through two squares on the same rank, file or diagonal, indexed by both squares. A pinned piece can only move along the line through its king and itself
+	 */
+	inline constexpr std::array<std::array<U64, 64>, 64> lineSquares = makeLineTable();
+
+}
+
+#endif //CHESSQDL_ATTACKS_HPP
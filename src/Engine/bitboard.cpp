@@ -1,12 +1,32 @@
 #include "bitboard.hpp"
 #include "const.hpp"
+#include "zobrist.hpp"
 
 #include <string>
+#include <sstream>
 #include <iostream>
 #include <cctype>
+#include <algorithm>
+#include <cassert>
 
 using namespace chessqdl;
 
+
+/**
+ * @brief Castling rights that remain after a piece moves from or to each square. Moving the king or a rook, or capturing a rook, removes the respective rights
+ */
+static const std::array<int, 64> castlingMask = [] {
+	std::array<int, 64> mask{};
+	mask.fill(cWhiteKing | cWhiteQueen | cBlackKing | cBlackQueen);
+	mask[a1] &= ~cWhiteQueen;
+	mask[h1] &= ~cWhiteKing;
+	mask[e1] &= ~(cWhiteKing | cWhiteQueen);
+	mask[a8] &= ~cBlackQueen;
+	mask[h8] &= ~cBlackKing;
+	mask[e8] &= ~(cBlackKing | cBlackQueen);
+	return mask;
+}();
+
 /**
  * @details Initializes bitboards in order to obtain the following board: <br><br>
  * r n b q k b n r <br>
@@ -32,11 +52,16 @@ Bitboard::Bitboard() {
 	bitBoards[nRook] = 0x81L | (0x81L << 56);
 	bitBoards[nQueen] = 0x8L | (0x8L << 56);
 	bitBoards[nKing] = 0x10L | (0x10L << 56);
+
+	updateMailbox();
+	key = computeKey();
+	states.reserve(maxGamePly);
 }
 
 
 /**
- * @details Constructor that uses a custom board, represented by the \p fen string.
+ * @details Constructor that uses a custom board, represented by the \p fen string. Besides the piece placement, the side to move, the castling rights and the en passant square are read.
+ * Move counters are ignored.
  */
 Bitboard::Bitboard(std::string fen) {
 	// Just to make sure that all bitboards start with value 0x0;
@@ -110,6 +135,47 @@ Bitboard::Bitboard(std::string fen) {
 
 	bitBoards[nColor] = bitBoards[nBlack] | bitBoards[nWhite];
 
+	std::istringstream fields(fen.substr(fen.find_first_of(' ') + 1));
+	std::string side = "w", castling = "-", ep = "-";
+	fields >> side >> castling >> ep;
+
+	sideToMove = (side == "b") ? nBlack : nWhite;
+
+	castlingRights = 0;
+	for (char c : castling) {
+		if (c == 'K') castlingRights |= cWhiteKing;
+		else if (c == 'Q') castlingRights |= cWhiteQueen;
+		else if (c == 'k') castlingRights |= cBlackKing;
+		else if (c == 'q') castlingRights |= cBlackQueen;
+	}
+
+	auto epIt = std::find(mapPositions.begin(), mapPositions.end(), ep);
+	epSquare = (epIt != mapPositions.end()) ? int(std::distance(mapPositions.begin(), epIt)) : noSquare;
+
+	updateMailbox();
+	key = computeKey();
+	states.reserve(maxGamePly);
+}
+
+
+Bitboard::Bitboard(const Bitboard &other) {
+	*this = other;
+}
+
+
+/**
+ * @details The state stack is reserved before the states are copied, so the copy never needs to grow it.
+ */
+Bitboard &Bitboard::operator=(const Bitboard &other) {
+	bitBoards = other.bitBoards;
+	board = other.board;
+	sideToMove = other.sideToMove;
+	castlingRights = other.castlingRights;
+	epSquare = other.epSquare;
+	key = other.key;
+	states.reserve(std::max<size_t>(maxGamePly, other.states.size()));
+	states.assign(other.states.begin(), other.states.end());
+	return *this;
 }
 
 /**
@@ -183,9 +249,9 @@ U64 Bitboard::getAllPieces() {
 }
 
 /**
- * @details Returns a copy of the std::array with the bitBoards attribute of the Bitboard class.
+ * @details Returns a reference to the std::array with the bitBoards attribute of the Bitboard class.
  */
-BitbArray Bitboard::getBitBoards() {
+const BitbArray &Bitboard::getBitBoards() const {
 	return bitBoards;
 }
 
@@ -197,45 +263,58 @@ void Bitboard::updateBitboard() {
 }
 
 /**
- * @details Resets the bit of index \p idx of the bitboard \p color
+ * @details Resets the bit of index \p idx of the bitboard \p color. The Zobrist key is computed again, since a single bitboard does not describe a piece
  */
 void Bitboard::resetBit(enumColor color, int idx) {
 	bitBoards[color].reset(idx);
+	key = computeKey();
 }
 
 /**
- * @details Resets the bit of index \p idx of the bitboard \p piece
+ * @details Resets the bit of index \p idx of the bitboard \p piece. The square is emptied on the mailbox if it was occupied by \p piece, and the Zobrist key is computed again
  */
 void Bitboard::resetBit(enumPiece piece, int idx) {
 	bitBoards[piece].reset(idx);
+	if (board[idx] == piece)
+		board[idx] = nNoPiece;
+	key = computeKey();
 }
 
 /**
- * @details Resets the bit of index \p idx of the bitboard \p i
+ * @details Resets the bit of index \p idx of the bitboard \p i. Piece bitboards are handled by Bitboard::resetBit(enumPiece, int) so the mailbox stays in sync
  */
 void Bitboard::resetBit(int i, int idx) {
-	bitBoards[i].reset(idx);
+	if (i >= nPawn)
+		resetBit(enumPiece(i), idx);
+	else
+		resetBit(enumColor(i), idx);
 }
 
 /**
- * @details Sets the bit of index \p idx of the bitboard \p color
+ * @details Sets the bit of index \p idx of the bitboard \p color. The Zobrist key is computed again, since a single bitboard does not describe a piece
  */
 void Bitboard::setBit(enumColor color, int idx) {
 	bitBoards[color].set(idx);
+	key = computeKey();
 }
 
 /**
- * @details Sets the bit of index \p idx of the bitboard \p piece
+ * @details Sets the bit of index \p idx of the bitboard \p piece, places \p piece on the mailbox and computes the Zobrist key again
  */
 void Bitboard::setBit(enumPiece piece, int idx) {
 	bitBoards[piece].set(idx);
+	board[idx] = piece;
+	key = computeKey();
 }
 
 /**
- * @details Sets the bit of index \p idx of the bitboard \p i
+ * @details Sets the bit of index \p idx of the bitboard \p i. Piece bitboards are handled by Bitboard::setBit(enumPiece, int) so the mailbox stays in sync
  */
 void Bitboard::setBit(int i, int idx) {
-	bitBoards[i].set(idx);
+	if (i >= nPawn)
+		setBit(enumPiece(i), idx);
+	else
+		setBit(enumColor(i), idx);
 }
 
 /**
@@ -260,79 +339,287 @@ bool Bitboard::testBit(int i, int idx) {
 }
 
 /**
- * @details Converts the board from bitboards to a fancy string and prints it to stdout.
+ * @details Reads the piece from the mailbox.
  */
-void Bitboard::printBoard() {
-	std::vector<std::string> board;
+enumPiece Bitboard::pieceOn(int idx) const {
+	return board[idx];
+}
 
-	std::string aux;
-	long unsigned int i;
 
-	for (i = 0; i < 64ul; i++)
-		board.push_back("-");
+/**
+ * @details Looks for the piece bitboard that has the bit of each square set.
+ */
+void Bitboard::updateMailbox() {
+	board.fill(nNoPiece);
 
-	for (i = 0; i < 64ul; i++) {
-		if (bitBoards[nPawn].test(i)) {
-			if (bitBoards[nBlack].test(i))
-				board[i] = "♟";
-			else
-				board[i] = "♙";
-		}
+	for (int i = nPawn; i <= nKing; i++)
+		for (int idx = 0; idx < 64; idx++)
+			if (bitBoards[i].test(idx))
+				board[idx] = enumPiece(i);
+}
+
+
+/**
+ * @details Returns Bitboard::sideToMove
+ */
+enumColor Bitboard::getSideToMove() const {
+	return sideToMove;
+}
+
+
+/**
+ * @details Returns Bitboard::castlingRights
+ */
+int Bitboard::getCastlingRights() const {
+	return castlingRights;
+}
+
+
+/**
+ * @details Returns Bitboard::epSquare
+ */
+int Bitboard::getEpSquare() const {
+	return epSquare;
+}
+
+
+/**
+ * @details Returns the size of the state stack
+ */
+int Bitboard::getHistoryLength() const {
+	return states.size();
+}
+
+
+/**
+ * @details Reads the move saved on top of the state stack
+ */
+Move Bitboard::getLastMove() const {
+	return states.empty() ? Move() : states.back().move;
+}
+
+
+/**
+ * @details Sets the bit of index \p idx on the bitboards of \p color, \p piece and on the bitboard with all pieces, and places \p piece on the mailbox
+ */
+void Bitboard::putPiece(enumColor color, enumPiece piece, int idx) {
+	bitBoards[color].set(idx);
+	bitBoards[piece].set(idx);
+	bitBoards[nColor].set(idx);
+	board[idx] = piece;
+	key ^= zobrist.pieces[color][piece - nPawn][idx];
+}
+
+
+/**
+ * @details Resets the bit of index \p idx on the bitboards of \p color, \p piece and on the bitboard with all pieces, and empties the square on the mailbox
+ */
+void Bitboard::removePiece(enumColor color, enumPiece piece, int idx) {
+	bitBoards[color].reset(idx);
+	bitBoards[piece].reset(idx);
+	bitBoards[nColor].reset(idx);
+	board[idx] = nNoPiece;
+	key ^= zobrist.pieces[color][piece - nPawn][idx];
+}
+
+
+/**
+ * @details Removes the piece from \p from and places it on \p to
+ */
+void Bitboard::movePiece(enumColor color, enumPiece piece, int from, int to) {
+	removePiece(color, piece, from);
+	putPiece(color, piece, to);
+}
+
+
+/**
+ * @details The state before the move (castling rights, en passant square and captured piece) is pushed to the state stack, so the move can be taken back by Bitboard::undoMove without
+ * regenerating or parsing anything. On castles the king move is given, and the rook is moved along with it. <br>
+ * The Zobrist key is updated along with every change: pieces are XORed in and out by Bitboard::putPiece and Bitboard::removePiece, and the keys of the en passant file, castling rights and
+ * side to move are swapped here. Debug builds check the result against a key computed from scratch.
+ */
+void Bitboard::doMove(Move mv) {
+	enumColor us = sideToMove;
+	enumColor them = (us == nWhite) ? nBlack : nWhite;
+
+	int from = mv.getFrom();
+	int to = mv.getTo();
+	int flags = mv.getFlags();
+	enumPiece piece = pieceOn(from);
+
+	StateInfo st{mv, nNoPiece, castlingRights, epSquare, key};
+
+	if (mv.isCapture()) {
+		// The pawn captured en passant is behind the destination square
+		int capturedIdx = (flags == fEnPassant) ? to + (us == nWhite ? sout : nort) : to;
+		st.captured = pieceOn(capturedIdx);
+		removePiece(them, st.captured, capturedIdx);
 	}
 
-	for (i = 0; i < 64ul; i++) {
-		if (bitBoards[nKnight].test(i)) {
-			if (bitBoards[nBlack].test(i))
-				board[i] = "♞";
-			else
-				board[i] = "♘";
-		}
+	states.push_back(st);
+
+	movePiece(us, piece, from, to);
+
+	if (flags == fKingCastle)
+		movePiece(us, nRook, to + 1, to - 1);
+	else if (flags == fQueenCastle)
+		movePiece(us, nRook, to - 2, to + 1);
+
+	if (mv.isPromotion()) {
+		removePiece(us, nPawn, to);
+		putPiece(us, mv.getPromotion(), to);
 	}
 
-	for (i = 0; i < 64ul; i++) {
-		if (bitBoards[nBishop].test(i)) {
-			if (bitBoards[nBlack].test(i))
-				board[i] = "♝";
-			else
-				board[i] = "♗";
-		}
+	if (epSquare != noSquare)
+		key ^= zobrist.epFile[epSquare % 8];
+
+	epSquare = (flags == fDoublePush) ? (from + to) / 2 : noSquare;
+
+	if (epSquare != noSquare)
+		key ^= zobrist.epFile[epSquare % 8];
+
+	key ^= zobrist.castling[castlingRights];
+	castlingRights &= castlingMask[from] & castlingMask[to];
+	key ^= zobrist.castling[castlingRights];
+
+	sideToMove = them;
+	key ^= zobrist.blackToMove;
+
+	assert(key == computeKey());
+}
+
+
+/**
+ * @details Pops the state of the last move from the state stack and does every step of Bitboard::doMove in reverse. The key saved before the move is restored instead of being updated.
+ */
+void Bitboard::undoMove() {
+	const StateInfo &st = states.back();
+
+	enumColor them = sideToMove;
+	enumColor us = (them == nWhite) ? nBlack : nWhite;
+
+	Move mv = st.move;
+	int from = mv.getFrom();
+	int to = mv.getTo();
+	int flags = mv.getFlags();
+
+	if (mv.isPromotion()) {
+		removePiece(us, mv.getPromotion(), to);
+		putPiece(us, nPawn, to);
 	}
 
-	for (i = 0; i < 64ul; i++) {
-		if (bitBoards[nRook].test(i)) {
-			if (bitBoards[nBlack].test(i))
-				board[i] = "♜";
-			else
-				board[i] = "♖";
-		}
+	if (flags == fKingCastle)
+		movePiece(us, nRook, to - 1, to + 1);
+	else if (flags == fQueenCastle)
+		movePiece(us, nRook, to + 1, to - 2);
+
+	movePiece(us, pieceOn(to), to, from);
+
+	if (mv.isCapture()) {
+		int capturedIdx = (flags == fEnPassant) ? to + (us == nWhite ? sout : nort) : to;
+		putPiece(them, st.captured, capturedIdx);
 	}
 
-	for (i = 0; i < 64ul; i++) {
-		if (bitBoards[nQueen].test(i)) {
-			if (bitBoards[nBlack].test(i))
-				board[i] = "♛";
+	castlingRights = st.castlingRights;
+	epSquare = st.epSquare;
+	sideToMove = us;
+	key = st.key;
+
+	states.pop_back();
+}
+
+
+/**
+ * @details Saves the state with a null move, so that Bitboard::getLastMove tells that the turn was passed. The en passant square is cleared, since the capture is no longer possible.
+ */
+void Bitboard::doNullMove() {
+	states.push_back({Move(), nNoPiece, castlingRights, epSquare, key});
+
+	if (epSquare != noSquare)
+		key ^= zobrist.epFile[epSquare % 8];
+	epSquare = noSquare;
+
+	sideToMove = (sideToMove == nWhite) ? nBlack : nWhite;
+	key ^= zobrist.blackToMove;
+
+	assert(key == computeKey());
+}
+
+
+/**
+ * @details Restores the state saved by Bitboard::doNullMove.
+ */
+void Bitboard::undoNullMove() {
+	const StateInfo &st = states.back();
+
+	epSquare = st.epSquare;
+	sideToMove = (sideToMove == nWhite) ? nBlack : nWhite;
+	key = st.key;
+
+	states.pop_back();
+}
+
+
+/**
+ * @details Converts the board from the mailbox to a fancy string and prints it to stdout.
+ */
+void Bitboard::printBoard() {
+	// Symbols indexed by piece type (from nPawn to nKing) for white and black pieces
+	static const std::array<std::string, 6> whiteSymbols = {"♙", "♘", "♗", "♖", "♕", "♔"};
+	static const std::array<std::string, 6> blackSymbols = {"♟", "♞", "♝", "♜", "♛", "♚"};
+
+	for (int i = 0; i < 64; i += 8) {
+		std::cout << "\033[1;33m" << (64 - i) / 8 << "  \033[0m";
+
+		for (int j = i + 7; j >= i; j--) {
+			int idx = 63 - j;
+
+			if (board[idx] == nNoPiece)
+				std::cout << "-";
+			else if (bitBoards[nBlack].test(idx))
+				std::cout << blackSymbols[board[idx] - nPawn];
 			else
-				board[i] = "♕";
+				std::cout << whiteSymbols[board[idx] - nPawn];
+
+			std::cout << " ";
 		}
+
+		std::cout << std::endl;
 	}
 
-	for (i = 0; i < 64ul; i++) {
-		if (bitBoards[nKing].test(i)) {
-			if (bitBoards[nBlack].test(i))
-				board[i] = "♚";
-			else
-				board[i] = "♔";
+	std::cout << "   \033[1;33ma b c d e f g h\033[0m" << std::endl;
+}
+
+
+/**
+ * @details Returns the key kept up to date by the functions that change the board.
+ */
+uint64_t Bitboard::getKey() const {
+	return key;
+}
+
+
+/**
+ * @details XORs the keys of every piece on the board, the side to move, the castling rights and the en passant file.
+ */
+uint64_t Bitboard::computeKey() const {
+	uint64_t k = 0;
+
+	for (int color = nWhite; color <= nBlack; color++) {
+		for (int piece = nPawn; piece <= nKing; piece++) {
+			U64 pieces = bitBoards[color] & bitBoards[piece];
+			while (pieces)
+				k ^= zobrist.pieces[color][piece - nPawn][pieces.popLsb()];
 		}
 	}
 
-	for (i = 0; i < 64; i += 8) {
-		std::cout << "\033[1;33m" << (64 - i) / 8 << "  \033[0m";
+	if (sideToMove == nBlack)
+		k ^= zobrist.blackToMove;
 
-		for (int j = int(i + 7); j >= int(i); j--)
-			std::cout << board[63 - j] << " ";
+	k ^= zobrist.castling[castlingRights];
 
-		std::cout << std::endl;
-	}
+	if (epSquare != noSquare)
+		k ^= zobrist.epFile[epSquare % 8];
 
-	std::cout << "   \033[1;33ma b c d e f g h\033[0m" << std::endl;
+	return k;
 }
@@ -1,12 +1,25 @@
 #ifndef CHESSQDL_BITBOARD_HPP
 #define CHESSQDL_BITBOARD_HPP
 
-#include <bitset>
+#include <vector>
 
 #include "const.hpp"
+#include "move.hpp"
 
 namespace chessqdl {
 
+	/**
+	 * @brief Information needed to take back a move. Saved by Bitboard::doMove and restored by Bitboard::undoMove
+	 */
+	struct StateInfo {
+		Move move;				// move that was made
+		enumPiece captured;		// type of the captured piece (nNoPiece if the move is not a capture)
+		int castlingRights;		// castling rights before the move
+		int epSquare;			// en passant square before the move
+		uint64_t key;			// Zobrist key before the move
+	};
+
+
 	class Bitboard {
 
 	private:
@@ -16,8 +29,76 @@ namespace chessqdl {
 		 */
 		BitbArray bitBoards;
 
+		/**
+		 * @brief Type of the piece on each square (nNoPiece for empty squares). Redundant with the piece bitboards, which it is kept in sync with, but allows piece lookups by square in constant time
+		 */
+		std::array<enumPiece, 64> board;
+
+		/**
+		 * @brief Color of the pieces to move
+		 */
+		enumColor sideToMove = nWhite;
+
+		/**
+		 * @brief Castling rights still available. Combination of enumCastling flags
+		 */
+		int castlingRights = cWhiteKing | cWhiteQueen | cBlackKing | cBlackQueen;
+
+		/**
+		 * @brief Square behind a pawn that has just moved twice (noSquare if the last move was not a double push)
+		 */
+		int epSquare = noSquare;
+
+		/**
+		 * @brief Zobrist key of the position. Updated incrementally whenever the board changes
+		 */
+		uint64_t key = 0;
+
+		/**
+		 * @brief Stack with the state of every move made. Memory for it is reserved up front by every constructor and copy, so making moves does not allocate
+		 */
+		std::vector<StateInfo> states;
+
+		/**
+		 * @brief Places a piece on an empty square, updating the color and piece bitboards and the Zobrist key
+		 * @param color  color of the piece
+		 * @param piece  type of the piece
+		 * @param idx  index of the square
+		 */
+		void putPiece(enumColor color, enumPiece piece, int idx);
+
+
+		/**
+		 * @brief Removes a piece from the board, updating the color and piece bitboards and the Zobrist key
+		 * @param color  color of the piece
+		 * @param piece  type of the piece
+		 * @param idx  index of the square
+		 */
+		void removePiece(enumColor color, enumPiece piece, int idx);
+
+
+		/**
+		 * @brief Moves a piece to an empty square, updating the color and piece bitboards
+		 * @param color  color of the piece
+		 * @param piece  type of the piece
+		 * @param from  index of the origin square
+		 * @param to  index of the destination square
+		 */
+		void movePiece(enumColor color, enumPiece piece, int from, int to);
+
+
+		/**
+		 * @brief Rebuilds Bitboard::board from the piece bitboards
+		 */
+		void updateMailbox();
+
 	public:
 
+		/**
+		 * @brief Maximum amount of moves the state stack holds without reallocating
+		 */
+		static constexpr int maxGamePly = 1024;
+
 		/**
 		 * @brief Default constructor. Initializes bitBoards according to a default initial chess board.
 		 */
@@ -29,6 +110,20 @@ namespace chessqdl {
 		 */
 		explicit Bitboard(std::string fen);
 
+		/**
+		 * @brief Copy constructor. The copy reserves the whole state stack as well, since copying a std::vector only keeps as much memory as its size
+		 */
+		Bitboard(const Bitboard &other);
+
+		/**
+		 * @brief Copy assignment. Reserves the whole state stack like the copy constructor
+		 */
+		Bitboard &operator=(const Bitboard &other);
+
+		Bitboard(Bitboard &&other) = default;
+
+		Bitboard &operator=(Bitboard &&other) = default;
+
 		/**
 		 * @brief Returns a bitboard containing all pawns of a given color
 		 * @param color  the color of desired pieces (nWhite or nBlack)
@@ -185,9 +280,9 @@ namespace chessqdl {
 
 		/**
 		 * @brief Returns the bitBoard attribute of the class
-		 * @return an array containing all bitboards
+		 * @return a reference to the array containing all bitboards
 		 */
-		BitbArray getBitBoards();
+		const BitbArray &getBitBoards() const;
 
 
 		/**
@@ -201,6 +296,81 @@ namespace chessqdl {
 		 */
 		void updateBitboard();
 
+
+		/**
+		 * @brief Returns the type of the piece on a square
+		 * @param idx  index of the square
+		 * @return the type of the piece on the square, or nNoPiece if the square is empty
+		 */
+		enumPiece pieceOn(int idx) const;
+
+
+		/**
+		 * @brief Returns the color of the pieces to move
+		 */
+		enumColor getSideToMove() const;
+
+
+		/**
+		 * @brief Returns the castling rights still available, as a combination of enumCastling flags
+		 */
+		int getCastlingRights() const;
+
+
+		/**
+		 * @brief Returns the square where an en passant capture is possible, or noSquare
+		 */
+		int getEpSquare() const;
+
+
+		/**
+		 * @brief Returns how many moves have been made with Bitboard::doMove and can be taken back
+		 */
+		int getHistoryLength() const;
+
+
+		/**
+		 * @brief Returns the last move made with Bitboard::doMove, or the null move if there is none
+		 */
+		Move getLastMove() const;
+
+
+		/**
+		 * @brief Makes a move without validating it and saves the information needed to take it back. Castles, en passant captures and promotions are handled according to the move flags
+		 * @param mv  move to be made. Must be a move generated for the current position
+		 */
+		void doMove(Move mv);
+
+
+		/**
+		 * @brief Takes back the last move made with Bitboard::doMove
+		 */
+		void undoMove();
+
+
+		/**
+		 * @brief Passes the turn to the other side without moving. Used by the null move pruning of the search. Must not be called when in check
+		 */
+		void doNullMove();
+
+
+		/**
+		 * @brief Takes back the null move made with Bitboard::doNullMove
+		 */
+		void undoNullMove();
+
+
+		/**
+		 * @brief Returns the Zobrist key of the position. Positions with the same pieces, side to move, castling rights and en passant square have the same key
+		 */
+		uint64_t getKey() const;
+
+
+		/**
+		 * @brief Computes the Zobrist key of the position from scratch. Used to initialize and verify the incrementally updated key
+		 */
+		uint64_t computeKey() const;
+
 	};
 
 }
@@ -0,0 +1,121 @@
+#ifndef CHESSQDL_BITBOARD64_HPP
+#define CHESSQDL_BITBOARD64_HPP
+
+#include <cstdint>
+
+namespace chessqdl {
+
+	/**
+	 * @brief Thin wrapper over a 64 bits unsigned integer, with one bit per square of the board. The interface mirrors the parts of std::bitset the engine uses, but every operation
+	 * is constexpr and compiles to plain integer instructions, so bitboards can also be computed at compile time. Bit scans and population counts use compiler builtins, which become single
+	 * instructions (TZCNT, POPCNT) when building with the CHESSQDL_BMI2 option.
+	 */
+	class Bitboard64 {
+
+	private:
+
+		/**
+		 * @brief Bits of the bitboard. Bit 0 is a1 and bit 63 is h8
+		 */
+		uint64_t bits;
+
+	public:
+
+		/**
+		 * @brief Default constructor. Creates an empty bitboard
+		 */
+		constexpr Bitboard64() : bits(0) {}
+
+		/**
+		 * @brief Creates a bitboard from its integer representation
+		 * @param value  integer with the bits of the bitboard
+		 */
+		constexpr Bitboard64(uint64_t value) : bits(value) {}
+
+		/**
+		 * @brief Returns the integer representation of the bitboard. Named after the equivalent std::bitset method
+		 */
+		constexpr uint64_t to_ullong() const { return bits; }
+
+		/**
+		 * @brief Returns true if the bit of index \p idx is set
+		 */
+		constexpr bool test(int idx) const { return (bits >> idx) & 1; }
+
+		/**
+		 * @brief Sets the bit of index \p idx
+		 */
+		constexpr void set(int idx) { bits |= uint64_t(1) << idx; }
+
+		/**
+		 * @brief Resets the bit of index \p idx
+		 */
+		constexpr void reset(int idx) { bits &= ~(uint64_t(1) << idx); }
+
+		/**
+		 * @brief Resets all bits
+		 */
+		constexpr void reset() { bits = 0; }
+
+		/**
+		 * @brief Returns the number of bits set
+		 */
+		constexpr int count() const { return __builtin_popcountll(bits); }
+
+		/**
+		 * @brief Returns true if any bit is set
+		 */
+		constexpr bool any() const { return bits != 0; }
+
+		/**
+		 * @brief Returns true if no bit is set
+		 */
+		constexpr bool none() const { return bits == 0; }
+
+		/**
+		 * @brief Returns the index of the least significant bit set. The bitboard must not be empty
+		 */
+		constexpr int lsb() const { return __builtin_ctzll(bits); }
+
+		/**
+		 * @brief Resets the least significant bit set and returns its index. The bitboard must not be empty
+		 */
+		constexpr int popLsb() {
+			int idx = lsb();
+			bits &= bits - 1;
+			return idx;
+		}
+
+		constexpr explicit operator bool() const { return bits != 0; }
+
+		constexpr Bitboard64 operator~() const { return ~bits; }
+
+		constexpr Bitboard64 operator<<(int n) const { return bits << n; }
+
+		constexpr Bitboard64 operator>>(int n) const { return bits >> n; }
+
+		constexpr Bitboard64 &operator<<=(int n) { bits <<= n; return *this; }
+
+		constexpr Bitboard64 &operator>>=(int n) { bits >>= n; return *this; }
+
+		constexpr Bitboard64 &operator&=(Bitboard64 other) { bits &= other.bits; return *this; }
+
+		constexpr Bitboard64 &operator|=(Bitboard64 other) { bits |= other.bits; return *this; }
+
+		constexpr Bitboard64 &operator^=(Bitboard64 other) { bits ^= other.bits; return *this; }
+
+		friend constexpr Bitboard64 operator&(Bitboard64 a, Bitboard64 b) { return a.bits & b.bits; }
+
+		friend constexpr Bitboard64 operator|(Bitboard64 a, Bitboard64 b) { return a.bits | b.bits; }
+
+		friend constexpr Bitboard64 operator^(Bitboard64 a, Bitboard64 b) { return a.bits ^ b.bits; }
+
+		friend constexpr bool operator==(Bitboard64 a, Bitboard64 b) { return a.bits == b.bits; }
+
+		friend constexpr bool operator!=(Bitboard64 a, Bitboard64 b) { return a.bits != b.bits; }
+
+	};
+
+}
+
+#endif //CHESSQDL_BITBOARD64_HPP
@@ -4,15 +4,16 @@
 #include <vector>
 #include <array>
 #include <string>
-#include <bitset>
 #include <limits>
 
+#include "bitboard64.hpp"
+
 namespace chessqdl {
 
 	/**
-	 * @brief Analogous to uint64, but bitset is used to take advantage of its methods.
+	 * @brief 64 bits bitboard. Analogous to uint64, with helper methods (see Bitboard64)
 	 */
-	typedef std::bitset<64> U64;
+	typedef Bitboard64 U64;
 
 	/**
 	 * @brief An std::array to comport all different bitboards that will be used throughout the project
@@ -22,8 +23,8 @@ namespace chessqdl {
 	/**
 	 * @brief Constants representing the board with all bits set except for A or H file
 	 */
-	const U64 notAFile = 0xfefefefefefefefe;
-	const U64 notHFile = 0x7f7f7f7f7f7f7f7f;
+	constexpr U64 notAFile = 0xfefefefefefefefe;
+	constexpr U64 notHFile = 0x7f7f7f7f7f7f7f7f;
 
 	/**
 	 * @brief Bitboard array indexing by color
@@ -43,7 +44,45 @@ namespace chessqdl {
 		nBishop,		// all bishops
 		nRook,			// all rooks
 		nQueen,			// all queens
-		nKing			// all kings
+		nKing,			// all kings
+		nNoPiece		// no piece. Not a valid bitboard index
+	};
+
+	/**
+	 * @brief Castling rights flags
+	 */
+	enum enumCastling {
+		cWhiteKing = 1,		// white can castle on the king side
+		cWhiteQueen = 2,	// white can castle on the queen side
+		cBlackKing = 4,		// black can castle on the king side
+		cBlackQueen = 8		// black can castle on the queen side
+	};
+
+	/**
+	 * @brief Implementations of the slider attack lookups
+	 */
+	enum enumSliderBackend {
+		backendAuto,		// chosen at startup according to the CPU features
+		backendMagic,		// magic bitboards (portable)
+		backendPext			// parallel bits extract (requires BMI2)
+	};
+
+	/**
+	 * @brief Ways of searching on several threads
+	 */
+	enum enumSearchMode {
+		modeLazySmp,		// all threads search the whole tree, sharing the transposition table. Fastest, but not reproducible
+		modeRootSplit,		// root moves are split between the threads and searched independently. Reproducible with any number of threads
+		modeYbwc			// Young Brothers Wait Concept: threads share the moves of a node once its first move has been searched
+	};
+
+	/**
+	 * @brief Kinds of moves the legal move generator can be asked for
+	 */
+	enum enumGenType {
+		gCaptures,			// captures, en passant captures and promotions
+		gQuiets,			// non-capturing moves other than promotions, including castles
+		gAll				// all moves
 	};
 
 	/**
@@ -95,6 +134,36 @@ namespace chessqdl {
 												   "a7", "b7", "c7", "d7", "e7", "f7", "g7", "h7",
 												   "a8", "b8", "c8", "d8", "e8", "f8", "g8", "h8"};
 
+	/**
+	 * @brief Material value of each piece in pawns, indexed by enumPiece. Same weights as the evaluation. Entries that are not pieces are worth 0
+	 */
+	constexpr int pieceValue[] = {0, 0, 0, 1, 3, 3, 5, 9, 200, 0};
+
+	/**
+	 * @brief Value used as square index when there is no square (e.g no en passant square)
+	 */
+	const int noSquare = -1;
+
+	/**
+	 * @brief Score of a checkmate. Mates found closer to the root are scored higher, by subtracting the distance to them
+	 */
+	const int scoreMate = 32000;
+
+	/**
+	 * @brief Bound of every score. Used as the initial search window
+	 */
+	const int scoreInfinite = 32001;
+
+	/**
+	 * @brief Maximum distance from the root the search can reach
+	 */
+	const int maxSearchPly = 128;
+
+	/**
+	 * @brief Depth limit of searches limited by time only
+	 */
+	const int maxSearchDepth = 64;
+
 	const int intMin = std::numeric_limits<int>::min();
 	const int intMax = std::numeric_limits<int>::max();
 
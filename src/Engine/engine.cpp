@@ -1,14 +1,33 @@
 #include "engine.hpp"
 #include "utils.hpp"
+#include "movepick.hpp"
+#include "perft.hpp"
 
 #include <iostream>
 #include <algorithm>
-#include <random>
 #include <chrono>
+#include <cmath>
+#include <array>
+#include <thread>
 
 using namespace chessqdl;
 
 
+/**
+ * @brief Depth reduction of the late moves, indexed by remaining depth and number of moves searched so far. Grows with the logarithm of both, so the later a move is and the deeper
+ * the node, the more it is reduced
+ */
+static const std::array<std::array<int, 64>, 64> lmrReductions = [] {
+	std::array<std::array<int, 64>, 64> table{};
+
+	for (int depth = 1; depth < 64; depth++)
+		for (int moveCount = 1; moveCount < 64; moveCount++)
+			table[depth][moveCount] = int(0.75 + std::log(depth) * std::log(moveCount) / 2.25);
+
+	return table;
+}();
+
+
 /**
  * @details Starts a new standard game of chess with the engine as \p color pieces
  */
@@ -28,7 +47,6 @@ Engine::Engine(enumColor color, int depth, bool v, bool p) {
 Engine::Engine(std::string fen, enumColor color, int depth, bool v, bool p) {
 	bitboard = Bitboard(fen);
 	pieceColor = color;
-	toMove = (fen.substr(fen.find(' ') + 1, 1) == "w") ? nWhite : nBlack;
 	depthLevel = depth;
 	beVerbose = v;
 	pvp = p;
@@ -44,10 +62,36 @@ void Engine::printBoard() {
 
 
 /**
- * @details Returns Engine::toMove
+ * @details Returns the side to move kept by the bitboard
  */
 enumColor Engine::getToMove() {
-	return toMove;
+	return bitboard.getSideToMove();
+}
+
+
+/**
+ * @details Reallocates the transposition table shared by this engine and its copies. Previous search results are lost.
+ */
+void Engine::setHashSize(size_t megabytes) {
+	hashSize = megabytes;
+	tt->resize(megabytes);
+	rootSplitTables.clear();
+}
+
+
+/**
+ * @details Takes effect on the next search. The helper threads are created by every search and joined before it returns.
+ */
+void Engine::setThreads(int n) {
+	threads = std::max(1, n);
+}
+
+
+/**
+ * @details Takes effect on the next search.
+ */
+void Engine::setSearchMode(enumSearchMode mode) {
+	searchMode = mode;
 }
 
 
@@ -68,16 +112,28 @@ void Engine::setDepth(int n) {
  * <b> move </b> or <b> mv </b> expects a string after the keyword with the move to be made. The move will only be made if a) it's your turn to move the desired pieces and b) the move is valid <br>
  * <b> undo </b> takes back the latest move made. Can take an argument after the keyword to specify the amount of moves to be unmade <br>
  * <b> depth </b> or <b> set_depth </b> specifies the new maximum search depth of the algorithm. The higher the maximum depth, the higher the difficulty of the engine <br>
+ * <b> time </b>, <b> inc </b>, <b> movestogo </b> and <b> movetime </b> set the engine's clock (see SearchLimits). The search depth still applies when playing on a clock <br>
+ * <b> perft </b> counts the leaf nodes of the tree of legal moves up to the depth given after the keyword (see Engine::perft) <br>
+ * <b> divide </b> does the same as <b> perft </b> and also prints the count of every legal move <br>
  * <b> exit </b> or <b> quit </b> exits the game without saving the progress <br>
  */
 void Engine::parser() {
 	std::string input;
 
 	while(true) {
-		if (pieceColor == toMove && !pvp) {
+		if (isGameOver())
+			break;
+
+		if (pieceColor == getToMove() && !pvp) {
 			if (this->beVerbose) std::cout << std::endl << "Searching for the next move..." << std::endl;
-			makeMove(getBestMove(depthLevel, pieceColor));
+			Move bestMove = getBestMove(depthLevel, pieceColor);
+			updateClock(timeManager.elapsed());
+			if (bestMove.isValid())
+				makeMove(bestMove);
+			else
+				std::cout << "No move found!" << std::endl;
 			printBoard();
+			continue;
 		}
 
 		std::cout << "> ";
@@ -94,7 +150,7 @@ void Engine::parser() {
 			int num = 1;
 			readInteger(num);
 			for (int i = 0; i < num; i++) {
-				if (!moveHistory.empty())
+				if (bitboard.getHistoryLength() > 0)
 					takeMove();
 				else {
 					std::cout << "Move history is empty!" << std::endl;
@@ -102,30 +158,52 @@ void Engine::parser() {
 				}
 			}
 		} else if (input == "restart") {
-			while (!moveHistory.empty())
+			while (bitboard.getHistoryLength() > 0)
 				takeMove();
 		} else if (input == "depth" || input == "set_depth") {
 			int d = 3;
 			readInteger(d);
 			setDepth(d);
+		} else if (input == "time") {
+			readInteger(limits.time);
+			std::cout << "Engine clock: " << limits.time << " ms" << std::endl;
+		} else if (input == "inc") {
+			readInteger(limits.increment);
+			std::cout << "Increment: " << limits.increment << " ms" << std::endl;
+		} else if (input == "movestogo") {
+			readInteger(limits.movesToGo);
+			std::cout << "Moves to go: " << limits.movesToGo << std::endl;
+		} else if (input == "movetime") {
+			readInteger(limits.moveTime);
+			std::cout << "Time per move: " << limits.moveTime << " ms" << std::endl;
+		} else if (input == "perft" || input == "divide") {
+			int d = 1;
+			readInteger(d);
+			perft(d, input == "divide");
 		} else if (input == "exit" || input == "quit")
 			break;
 		else if (input == "list") {
-			auto moves = MoveGenerator::getPseudoLegalMoves(bitboard.getBitBoards(), toMove);
+			auto moves = MoveGenerator::getLegalMoves(bitboard);
 			for (auto &mv : moves)
-				std::cout << mv << std::endl;
+				std::cout << mv.toString() << std::endl;
 		} else if (input == "help") {
 			std::cout << "print_board (print for short) - prints out the current state of the board" << std::endl;
 			std::cout << "move (mv for short)           - makes a movement if valid. 'move' and 'mv' can be omitted" << std::endl;
 			std::cout << "set_depth (depth for short)   - specifies the search depth of the minimax algorithm. Used to adjust difficulty of the engine" << std::endl;
+			std::cout << "time                          - sets the time left on the engine's clock, in milliseconds. 0 disables the clock" << std::endl;
+			std::cout << "inc                           - sets the time added to the engine's clock after each move, in milliseconds" << std::endl;
+			std::cout << "movestogo                     - sets the amount of moves until the next time control. 0 means the clock must last the whole game" << std::endl;
+			std::cout << "movetime                      - sets a fixed thinking time per move, in milliseconds. 0 disables it" << std::endl;
 			std::cout << "list                          - prints out a list of valid moves in the expected format" << std::endl;
+			std::cout << "perft                         - counts the leaf nodes of the tree of valid moves up to the given depth. Used to test the move generator" << std::endl;
+			std::cout << "divide                        - same as perft, but also prints the count of every valid move" << std::endl;
 			std::cout << "undo                          - takes a movement from the stack. Accepts an integer as argument to specify the amount of moves to be taken" << std::endl;
 			std::cout << "restart                       - starts a new match with the standard board configuration" << std::endl;
 			std::cout << "help                          - prints out this message with information about valid commands" << std::endl;
 			std::cout << "exit (or quit)                - exits the game" << std::endl;
 		} else {
-			auto moves = MoveGenerator::getPseudoLegalMoves(bitboard.getBitBoards(), toMove);
-			if (std::find(moves.begin(), moves.end(), input) != moves.end()) {
+			auto moves = MoveGenerator::getLegalMoves(bitboard);
+			if (std::find_if(moves.begin(), moves.end(), [&input](const Move &m) { return m.toString() == input; }) != moves.end()) {
 				makeMove(input);
 				printBoard();
 			} else {
@@ -136,316 +214,904 @@ void Engine::parser() {
 			}
 		}
 
-		if (bitboard.getKing(nWhite) == 0) {
-			std::cout << std::endl << "Game over! Black wins" << std::endl;
-			break;
-		} else if (bitboard.getKing(nBlack) == 0) {
-			std::cout << std::endl << "Game over! White wins" << std::endl;
-			break;
-		}
+	}
+
+}
+
 
+/**
+ * @details The divide counts are printed in the notation of the player interface, one move per line, so they can be compared line by line with the output of other engines. The nodes
+ * per second count the leaf nodes of the whole tree, including those of the subtrees found in the table.
+ */
+void Engine::perft(int depth, bool divide) {
+	if (depth < 0) {
+		std::cout << "Invalid depth!" << std::endl;
+		return;
 	}
 
+	auto begin = std::chrono::steady_clock::now();
+	uint64_t nodes = 0;
+
+	if (depth > 0) {
+		PerftTable table(hashSize);
+
+		for (const auto &[mv, count] : Perft::divide(bitboard, depth, threads, &table)) {
+			if (divide)
+				std::cout << mv.toString() << ": " << count << std::endl;
+			nodes += count;
+		}
+
+		if (divide)
+			std::cout << std::endl;
+	} else
+		nodes = Perft::perft(bitboard, depth);
+
+	auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+
+	std::cout << "Nodes searched: " << nodes << std::endl;
+	std::cout << "Time taken: " << elapsed / 1000 << " ms" << std::endl;
+	std::cout << "Nodes per second: " << nodes * 1000000 / std::max<uint64_t>(1, elapsed) << std::endl;
+}
+
+
+/**
+ * @details The game is over when the player to move has no legal moves: it is a checkmate if the king is in check and a stalemate otherwise.
+ */
+bool Engine::isGameOver() {
+	if (!MoveGenerator::getLegalMoves(bitboard).empty())
+		return false;
+
+	if (MoveGenerator::getCheckers(bitboard).none())
+		std::cout << std::endl << "Game over! Stalemate" << std::endl;
+	else if (getToMove() == nWhite)
+		std::cout << std::endl << "Game over! Black wins by checkmate" << std::endl;
+	else
+		std::cout << std::endl << "Game over! White wins by checkmate" << std::endl;
+
+	return true;
 }
 
 
 /**
- * @brief Moves a piece from a square to another and updates the bitboards, the move history and the capture history when necessary
+ * @details Looks for \p mv in the list of legal moves of the player to move. If it's found, the move is made by Engine::makeMove(Move, bool). This is the only place where moves are parsed from strings
+ */
+void Engine::makeMove(const std::string &mv, bool verbose) {
+	auto legal = MoveGenerator::getLegalMoves(bitboard);
+	auto it = std::find_if(legal.begin(), legal.end(), [&mv](const Move &m) { return m.toString() == mv; });
+
+	if (it == legal.end())
+		std::cout << "Invalid move!" << std::endl;
+	else
+		makeMove(*it, verbose);
+}
+
+
+/**
+ * @brief Makes a move on the board and prints it when asked to
  * @param mv  the move to be made
  * @param verbose  whether or not to print the move made (in algebraic notation) to stdout. This flag is used so that the engine won't flood stdout with all the moves it has made while searching for
  * the optimal one
  */
-void Engine::makeMove(std::string mv, bool verbose) {
-	auto pseudoLegal = MoveGenerator::getPseudoLegalMoves(bitboard.getBitBoards(), toMove);
-	bool found = std::find(pseudoLegal.begin(), pseudoLegal.end(), mv) != pseudoLegal.end();
+void Engine::makeMove(Move mv, bool verbose) {
+	// The notation depends on the board before the move is made
+	std::string notation;
+	if (verbose)
+		notation = moveNotation(mv);
 
-	enumColor otherPlayer = (toMove == nWhite) ? nBlack : nWhite;
+	bitboard.doMove(mv);
 
-	if (!found)
-		std::cout << "Invalid move!" << std::endl;
-	else {
-		// Source square
-		std::string from = mv.substr(0, 2);
-		// Destination square
-		std::string to = mv.substr(2, 2);
-
-		// Iterators to the respective square name
-		auto fromIt = std::find(mapPositions.begin(), mapPositions.end(), from);
-		auto toIt = std::find(mapPositions.begin(), mapPositions.end(), to);
-
-		// Index of the respective square
-		int fromIdx = std::distance(mapPositions.begin(), fromIt);
-		int toIdx = std::distance(mapPositions.begin(), toIt);
-
-		// Type of the piece that is being moved
-		enumPiece pieceType = nPawn;
-
-		// It is assumed that the moving piece is a pawn. This loop checks verifies if it's true and if it isn't, it changes the piece type
-		for (int i = nPawn; i <= nKing; i++) {
-			U64 aux = bitboard.getPiecesAt(i) & bitboard.getPieces(toMove);
-			if (aux.test(fromIdx)) {
-				pieceType = enumPiece(i);
-				break;
+	++ply;
+
+	if (verbose)
+		std::cout << notation << std::endl;
+}
+
+
+/**
+ * @details The notation is composed by the move number (if it's white's move), the letter of the moving piece (except for pawns), the origin square, an 'x' for captures, the destination square and
+ * the letter of the promoted piece, if any.
+ */
+std::string Engine::moveNotation(Move mv) {
+	std::string notation;
+
+	// Move number before the string when appropriate (if ply is even)
+	if (ply % 2 == 0)
+		notation = std::to_string(ply / 2 + 1) + ". ";
+
+	enumPiece piece = bitboard.pieceOn(mv.getFrom());
+	if (piece != nPawn)
+		notation += "PNBRQK"[piece - nPawn];
+
+	std::string name = mv.toString();
+	if (mv.isCapture())
+		name.insert(2, "x");
+
+	return notation + name;
+}
+
+
+/**
+ * @details Takes back the latest move made on the board with Bitboard::undoMove.
+ */
+void Engine::takeMove() {
+	if (bitboard.getHistoryLength() > 0) {
+		bitboard.undoMove();
+		--ply;
+	}
+}
+
+
+/**
+ * @details Iterative deepening: searches with depth 1, 2, ... up to \p depth, each iteration with an aspiration window around the score of the previous one. With more than one thread,
+ * helper threads search the same position in parallel (see Engine::helperSearch), or join the split points of this thread in YBWC mode (see Engine::ybwcHelperLoop), while this thread keeps the clock and reports the results. \p color must be the side to move, whose point of view the reported scores take, otherwise no search is made and a null move is returned. Every iteration leaves its results in the transposition table, the killer moves and the history, so the next one starts
+ * with the best moves of the previous iteration and cuts off sooner, and the total effort stays close to a single search of the last depth. <br>
+ * The search can be stopped with Engine::stop at any moment. The iteration in progress is then discarded and the move of the last completed iteration is returned. <br>
+ * When the engine plays on a clock, the TimeManager decides when to stop: no iteration is started after the soft limit and the search is stopped at the hard limit, once at least one
+ * iteration has been completed.
+ */
+Move Engine::getBestMove(int depth, enumColor color) {
+	// The search always plays the side to move, so there is no move to find for the other side
+	if (color != bitboard.getSideToMove())
+		return Move();
+
+	Move bestMove;
+	nodesVisited = 0;
+
+	auto begin = std::chrono::steady_clock::now();
+
+	tt->newSearch();
+	history.age();
+	stopFlag->store(false);
+	principalVariation.clear();
+	timeManager.start(limits);
+	completedDepth = 0;
+	aspirationFailHighs = aspirationFailLows = 0;
+	int score = 0;
+
+	// Lazy SMP: the helpers are copies of the engine, with their own board and history, that share the transposition table and the stop flag
+	// YBWC: the helpers share the list of split points as well, and only search the moves handed out by the split points of this thread
+	if (searchMode == modeYbwc && threads > 1)
+		splitPoints = std::make_shared<SplitPointList>();
+
+	std::vector<Engine> helpers((searchMode == modeLazySmp || splitPoints) ? threads - 1 : 0, *this);
+	std::vector<std::thread> helperThreads;
+	for (int id = 1; id <= int(helpers.size()); id++) {
+		if (splitPoints)
+			helperThreads.emplace_back(&Engine::ybwcHelperLoop, &helpers[id - 1]);
+		else
+			helperThreads.emplace_back(&Engine::helperSearch, &helpers[id - 1], depth, id);
+	}
+
+	// Root splitting: every root move has its own engine, with a private transposition table, so its results do not depend on which thread searches it, nor on what the other threads do
+	MoveList rootMoves;
+	std::vector<Engine> rootWorkers;
+	std::unique_ptr<ThreadPool> pool;
+	if (searchMode == modeRootSplit) {
+		MoveGenerator::getLegalMoves(bitboard, rootMoves);
+		rootWorkers.reserve(rootMoves.size());
+
+		// The tables of the previous search are reused if the root has as many moves, and emptied in constant time by TranspositionTable::newSearch
+		if (int(rootSplitTables.size()) != rootMoves.size()) {
+			rootSplitTables.clear();
+			for (int i = 0; i < rootMoves.size(); i++) {
+				auto table = std::make_shared<TranspositionTable>(0, true);
+				table->resizeBytes(hashSize * 1024 * 1024 / rootMoves.size());
+				rootSplitTables.push_back(table);
 			}
+		} else
+			for (auto &table : rootSplitTables)
+				table->newSearch();
+
+		for (int i = 0; i < rootMoves.size(); i++) {
+			Move mv = rootMoves[i];
+			Engine &worker = rootWorkers.emplace_back(*this);
+			worker.beVerbose = false;
+			worker.tt = rootSplitTables[i];
+			worker.history.clear();
+			std::fill(&worker.killers[0][0], &worker.killers[0][0] + maxSearchPly * 2, Move());
+			worker.bitboard.doMove(mv);
 		}
 
-		// Inserts the appropriate character into the algebraic notation string
-		switch (pieceType) {
-			case nKnight:
-				mv.insert(0, "N");
-				break;
-			case nBishop:
-				mv.insert(0, "B");
-				break;
-			case nRook:
-				mv.insert(0, "R");
-				break;
-			case nQueen:
-				mv.insert(0, "Q");
-				break;
-			case nKing:
-				mv.insert(0, "K");
-				break;
-			default:
-				break;
+		pool = std::make_unique<ThreadPool>(threads);
+	}
+
+	if (this->beVerbose && limits.isTimed())
+		std::cout << "Time limits: " << timeManager.getSoftLimit() << " ms soft, " << timeManager.getHardLimit() << " ms hard" << std::endl;
+
+	for (int currentDepth = 1; currentDepth <= depth && !stopFlag->load(); currentDepth++) {
+		score = (searchMode == modeRootSplit) ? rootSplitSearch(currentDepth, rootMoves, rootWorkers, *pool) : aspirationSearch(currentDepth, score);
+
+		if (stopFlag->load() || pvLength[0] == 0)
+			break;
+
+		Move iterationMove = pvTable[0][0];
+		timeManager.iterationCompleted(bestMove.isValid() && iterationMove != bestMove);
+		bestMove = iterationMove;
+		completedDepth = currentDepth;
+		principalVariation.assign(pvTable[0], pvTable[0] + pvLength[0]);
+
+		if (this->beVerbose) {
+			auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+
+			std::cout << "Depth " << currentDepth << " score " << scoreToString(score) << " nodes " << nodesVisited << " nps " << nodesVisited * 1000000L / std::max(1L, long(elapsed))
+					  << " time " << elapsed / 1000 << " ms pv";
+			for (Move mv : principalVariation)
+				std::cout << " " << mv.toString();
+			std::cout << std::endl;
 		}
 
-		// If a piece is being captured
-		if (bitboard.testBit(otherPlayer, toIdx)) {
-			for (int i = nPawn; i <= nKing; i++) {
-				U64 aux = bitboard.getPiecesAt(i) & bitboard.getPieces(otherPlayer);
-				if (aux.test(toIdx)) {
-					bitboard.resetBit(i, toIdx);
-					captureHistory.push(enumColor(i));
-					mv.insert(mv.find_first_of("12345678") + 1, "x");
-					break;
-				}
+		if (timeManager.softLimitReached())
+			break;
+	}
+
+	// The search ends with the main thread
+	if (!helperThreads.empty()) {
+		stopFlag->store(true);
+
+		if (splitPoints) {
+			{
+				std::lock_guard<std::mutex> lock(splitPoints->mutex);
+				splitPoints->quit = true;
 			}
-			// Removes piece from the board
-			bitboard.resetBit(otherPlayer, toIdx);
+			splitPoints->wakeUp.notify_all();
 		}
 
-		// Updates bitboards
-		bitboard.resetBit(pieceType, fromIdx);
-		bitboard.resetBit(toMove, fromIdx);
-		bitboard.setBit(pieceType, toIdx);
-		bitboard.setBit(toMove, toIdx);
+		for (auto &thread : helperThreads)
+			thread.join();
+		for (const Engine &helper : helpers)
+			nodesVisited += helper.nodesVisited;
 
-		// If is promotion
-		if (isalpha(mv.back()) && pieceType == nPawn) {
-			// Promote to queen by default
-			enumPiece promoteTo = nQueen;
+		splitPoints.reset();
+	}
 
-			if (mv.back() == 'n') promoteTo = nKnight;
-			else if (mv.back() == 'b') promoteTo = nBishop;
-			else if (mv.back() == 'r') promoteTo = nRook;
+	// Stopped before the first iteration was completed
+	if (!bestMove.isValid()) {
+		MoveList moves;
+		MoveGenerator::getLegalMoves(bitboard, moves);
+		if (!moves.empty())
+			bestMove = moves[0];
+	}
 
-			bitboard.setBit(promoteTo, toIdx);
-			bitboard.resetBit(pieceType, toIdx);
-		}
+	auto end = std::chrono::steady_clock::now();
 
+	if (this->beVerbose) {
+		std::cout << "Best move found: " << bestMove.toString() << std::endl;
+		std::cout << "Nodes visited: " << nodesVisited << std::endl;
+		std::cout << "Hash usage: " << tt->hashfull() / 10.0 << "%" << std::endl;
+		std::cout << "Aspiration windows: " << aspirationFailHighs << " fail high, " << aspirationFailLows << " fail low" << std::endl;
+		std::cout << "Time taken: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << " ms" << std::endl;
+	}
 
-		// Updates the bitboard that contains info about both players
-		bitboard.updateBitboard();
 
-		// Move number after the string when appropriate (if ply is even)
-		if (ply % 2 == 0)
-			mv = std::to_string(ply / 2 + 1) + ". " + mv;
+	return bestMove;
+}
 
-		++ply;
 
-		// Updates move history
-		moveHistory.push(mv);
+/**
+ * @details The window starts at Engine::aspirationWindow pawns on each side of \p previousScore, and the bound that fails is moved past the returned score by a margin that doubles
+ * after every failure. Searches with a narrow window cut off more often, and the score rarely moves far between iterations, so the re-searches cost less than they save. The first
+ * iterations and mate scores are searched with the full window.
+ * @ref https://www.chessprogramming.org/Aspiration_Windows
+ */
+int Engine::aspirationSearch(int depth, int previousScore) {
+	if (!features.aspirationWindows || depth < aspirationMinDepth || std::abs(previousScore) >= scoreMate - maxSearchPly)
+		return search(-scoreInfinite, scoreInfinite, depth, 0, true);
+
+	int delta = aspirationWindow;
+	int alpha = std::max(previousScore - delta, -scoreInfinite);
+	int beta = std::min(previousScore + delta, scoreInfinite);
+
+	while (true) {
+		int score = search(alpha, beta, depth, 0, true);
+
+		if (stopFlag->load())
+			return score;
+
+		delta *= 2;
+
+		if (score <= alpha) {
+			aspirationFailLows++;
+			alpha = (score - delta <= -scoreMate + maxSearchPly) ? -scoreInfinite : score - delta;
+		} else if (score >= beta) {
+			aspirationFailHighs++;
+			beta = (score + delta >= scoreMate - maxSearchPly) ? scoreInfinite : score + delta;
+		} else
+			return score;
+	}
+}
 
-		toMove = otherPlayer;
 
-		if (verbose)
-			std::cout << mv << std::endl;
+/**
+ * @details Helpers go through the same iterations as the main thread, but the search of the same position by several threads at once is spread out by the transposition table: a helper
+ * that reaches a node already searched by another thread gets its results from the table, and goes on to other moves sooner. The depth of odd helpers is one ahead, so they fill the table
+ * with results the main thread needs in its next iteration.
+ * @ref https://www.chessprogramming.org/Lazy_SMP
+ */
+void Engine::helperSearch(int depth, int id) {
+	beVerbose = false;
+	nodesVisited = 0;
+	completedDepth = 0;
+	int score = 0;
+
+	for (int currentDepth = 1 + id % 2; currentDepth <= depth && !stopFlag->load(); currentDepth++) {
+		score = aspirationSearch(currentDepth, score);
+		if (!stopFlag->load())
+			completedDepth = currentDepth;
 	}
 }
 
 
 /**
- * @details Removes the latest entry to the move history and updates the bitboards accordingly.
+ * @details Every root move is searched by its own engine with the full window, so its score is exact and only depends on the move and the depth. The searches of earlier iterations are
+ * the only state an engine keeps, and every iteration searches every root move, so the same position and depth always give the same scores. The best move is the one with the highest
+ * score, the first one in generation order on ties, which makes the result independent of the number of threads and the order the searches finish in. <br>
+ * The price is that no root move can be cut off by the others.
  */
-void Engine::takeMove() {
+int Engine::rootSplitSearch(int depth, const MoveList &rootMoves, std::vector<Engine> &workers, ThreadPool &pool) {
+	std::vector<int> scores(rootMoves.size());
+
+	for (Engine &worker : workers)
+		worker.completedDepth = completedDepth;
+
+	pool.run(rootMoves.size(), [&](int i) {
+		scores[i] = -workers[i].search(-scoreInfinite, scoreInfinite, depth - 1, 1, true);
+	});
+
+	nodesVisited = 0;
+	for (const Engine &worker : workers)
+		nodesVisited += worker.nodesVisited;
+
+	pvLength[0] = 0;
+	if (rootMoves.empty() || stopFlag->load())
+		return 0;
+
+	int best = 0;
+	for (int i = 1; i < rootMoves.size(); i++)
+		if (scores[i] > scores[best])
+			best = i;
+
+	const Engine &worker = workers[best];
+	pvTable[0][0] = rootMoves[best];
+	for (int i = 1; i < worker.pvLength[1]; i++)
+		pvTable[0][i] = worker.pvTable[1][i];
+	pvLength[0] = std::max(1, worker.pvLength[1]);
+
+	return scores[best];
+}
 
-	if (!moveHistory.empty()) {
 
-		std::string lastMove = moveHistory.top();
-		moveHistory.pop();
+/**
+ * @details The clock is read every 2048 nodes only, which keeps the overhead of timed searches negligible. The move of the first iteration is needed, so it is never interrupted.
+ */
+void Engine::checkTime() {
+	if (completedDepth > 0 && timeManager.hardLimitReached())
+		stop();
+}
 
-		if (lastMove.find(" ") != std::string::npos) {
-			lastMove = lastMove.substr(lastMove.find(" ") + 1);
+
+/**
+ * @details Time used is taken from the clock and the increment added to it. When the moves to go reach zero the game continues in sudden death until a new time control is set.
+ */
+void Engine::updateClock(int usedTime) {
+	if (limits.time > 0) {
+		limits.time = std::max(1, limits.time - usedTime) + limits.increment;
+
+		if (limits.movesToGo > 0)
+			limits.movesToGo--;
+	}
+}
+
+
+/**
+ * @details Replaces the clock of the engine.
+ */
+void Engine::setLimits(const SearchLimits &newLimits) {
+	limits = newLimits;
+}
+
+
+/**
+ * @details Replaces the techniques in use. Takes effect on the next search.
+ */
+void Engine::setFeatures(const SearchFeatures &newFeatures) {
+	features = newFeatures;
+}
+
+
+/**
+ * @details Sets the flag shared by the engine and its copies. Searches check it at every node.
+ */
+void Engine::stop() {
+	stopFlag->store(true);
+}
+
+
+long Engine::getNodesVisited() const {
+	return nodesVisited;
+}
+
+
+/**
+ * @details Returns the line saved from the PV table after the last completed iteration.
+ */
+std::vector<Move> Engine::getPrincipalVariation(int maxLength) {
+	if (int(principalVariation.size()) <= maxLength)
+		return principalVariation;
+
+	return std::vector<Move>(principalVariation.begin(), principalVariation.begin() + maxLength);
+}
+
+
+/**
+ * @details Scores are printed from the engine's point of view. Mate scores are printed as the amount of moves to mate, negative when the engine is the one being mated.
+ */
+std::string Engine::scoreToString(int score) {
+	if (score >= scoreMate - maxSearchPly)
+		return "mate " + std::to_string((scoreMate - score + 1) / 2);
+	if (score <= -scoreMate + maxSearchPly)
+		return "mate -" + std::to_string((scoreMate + score) / 2);
+	return std::to_string(score);
+}
+
+
+/**
+ * @details Negamax principal variation search. Scores are always from the point of view of the side to move, so a single function searches for both sides by negating the scores of the
+ * children. The first move of every node is searched with the full window. The other moves are only expected to be worse, which is proved with a null window (alpha, alpha + 1); moves
+ * that turn out better are searched again with the full window. <br>
+ * Moves are handed out by a MovePicker, so the moves that are most likely to cause a cutoff are searched first and the quiet moves are only generated if no capture or killer move
+ * caused one. A quiet move that causes a cutoff becomes a killer move and the countermove of the previous move, and its history score grows while the quiet moves tried before it lose some. Results are saved in the transposition table, and entries deep enough end the search of non-PV nodes if their bound allows it. <br>
+ * The best line of each node is kept in a triangular PV table: row \p searchPly holds the best move of the node followed by the line of its best child. <br>
+ * Nodes outside the principal variation are searched selectively (see SearchFeatures): they may be cut off by reverse futility pruning or null move pruning before any move is
+ * searched, quiet moves may be skipped by futility pruning, and late quiet moves and losing captures are searched at a reduced depth first. None of this applies in check.
+ * @ref https://www.chessprogramming.org/Principal_Variation_Search <br>
+ * https://www.chessprogramming.org/Triangular_PV-Table <br>
+ * https://www.chessprogramming.org/Null_Move_Pruning <br>
+ * https://www.chessprogramming.org/Late_Move_Reductions <br>
+ * https://www.chessprogramming.org/Futility_Pruning
+ */
+int Engine::search(int alpha, int beta, int depth, int searchPly, bool pvNode) {
+	pvLength[searchPly] = searchPly;
+
+	if (stopped())
+		return 0;
+
+	if (depth <= 0)
+		return quiescence(alpha, beta, searchPly);
+
+	if (searchPly >= maxSearchPly - 1)
+		return evaluateBoard(bitboard.getBitBoards(), bitboard.getSideToMove());
+
+	uint64_t key = bitboard.getKey();
+	TTEntry entry{};
+	Move ttMove;
+
+	if (tt->probe(key, entry)) {
+		ttMove = entry.move;
+		int ttScore = TranspositionTable::scoreFromTT(entry.score, searchPly);
+
+		if (!pvNode && entry.depth >= depth
+			&& (entry.bound == bExact || (entry.bound == bLower && ttScore >= beta) || (entry.bound == bUpper && ttScore <= alpha)))
+			return ttScore;
+	}
+
+	enumColor us = bitboard.getSideToMove();
+	const BitbArray &pieces = bitboard.getBitBoards();
+	bool inCheck = MoveGenerator::getCheckers(bitboard).any();
+	// Only the pruning of non-PV nodes needs the static evaluation
+	int staticEval = (inCheck || pvNode) ? -scoreInfinite : evaluateBoard(pieces, us);
+
+	// Mate scores must be neither returned by nor compared to the static evaluation
+	bool mateBounds = std::abs(alpha) >= scoreMate - maxSearchPly || std::abs(beta) >= scoreMate - maxSearchPly;
+
+	if (!pvNode && !inCheck && !mateBounds) {
+		// Reverse futility pruning: close to the leaves, a position far above beta is not expected to fall below it
+		if (features.reverseFutility && depth <= futilityDepth && staticEval - futilityMargin * depth >= beta)
+			return staticEval;
+
+		// Null move pruning: if passing the turn still fails high at a reduced depth, a real move would too. Not tried without pieces, since then zugzwang is the rule
+		int material = pieceValue[nKnight] * (pieces[nKnight] & pieces[us]).count() + pieceValue[nBishop] * (pieces[nBishop] & pieces[us]).count()
+					   + pieceValue[nRook] * (pieces[nRook] & pieces[us]).count() + pieceValue[nQueen] * (pieces[nQueen] & pieces[us]).count();
+
+		if (features.nullMove && depth >= nullMoveMinDepth && searchPly >= nullMoveMinPly && staticEval >= beta && material > 0 && bitboard.getLastMove().isValid()) {
+			int reduction = depth > 6 ? 3 : 2;
+
+			bitboard.doNullMove();
+			int score = -search(-beta, -beta + 1, depth - 1 - reduction, searchPly + 1, false);
+			bitboard.undoNullMove();
+
+			if (stopped())
+				return 0;
+
+			if (score >= beta) {
+				if (score >= scoreMate - maxSearchPly)
+					score = beta;
+
+				if (material > zugzwangMaterial)
+					return score;
+
+				// Verification: a normal search at the reduced depth, without null moves, must fail high as well
+				nullMoveMinPly = maxSearchPly;
+				int verification = search(beta - 1, beta, depth - reduction, searchPly, false);
+				nullMoveMinPly = 0;
+
+				if (verification >= beta)
+					return score;
+			}
 		}
+	}
+
+	// Futility pruning: close to the leaves, quiet moves cannot raise a position far below alpha
+	bool futile = features.futility && !pvNode && !inCheck && !mateBounds && depth <= futilityDepth && staticEval + futilityMargin * depth <= alpha;
+
+	MovePicker picker(bitboard, ttMove, killers[searchPly][0], killers[searchPly][1], &history);
+
+	int bestScore = -scoreInfinite;
+	int movesSearched = 0;
+	Move nodeBestMove;
+	MoveList quietsTried;
+
+	for (Move currentMove = picker.nextMove(); currentMove.isValid(); currentMove = picker.nextMove()) {
+		int score;
+		if (!searchMove(currentMove, movesSearched, alpha, beta, depth, searchPly, pvNode, inCheck, futile, score))
+			continue;
+
+		movesSearched++;
+
+		// The score of an interrupted search is meaningless and must not reach the transposition table
+		if (stopped())
+			return 0;
+
+		if (score > bestScore) {
+			bestScore = score;
 
-		enumPiece pieceType = nPawn;
-		bool captured = false;
-
-		// Figures out the piece that was moved
-		if (lastMove.find_first_of("NBRQK") != std::string::npos) {
-			if (lastMove.at(0) == 'N')
-				pieceType = nKnight;
-			else if (lastMove.at(0) == 'B')
-				pieceType = nBishop;
-			else if (lastMove.at(0) == 'R')
-				pieceType = nRook;
-			else if (lastMove.at(0) == 'Q')
-				pieceType = nQueen;
-			else if (lastMove.at(0) == 'K')
-				pieceType = nKing;
-
-			lastMove.erase(0, 1);
+			if (score > alpha) {
+				nodeBestMove = currentMove;
+
+				if (score >= beta) {
+					if (!currentMove.isCapture() && !currentMove.isPromotion()) {
+						storeKiller(currentMove, searchPly);
+						history.update(bitboard.getSideToMove(), currentMove, quietsTried, depth, bitboard.getLastMove());
+					}
+					tt->store(key, depth, bLower, TranspositionTable::scoreToTT(score, searchPly), currentMove);
+					return score;
+				}
+
+				alpha = score;
+
+				pvTable[searchPly][searchPly] = currentMove;
+				for (int i = searchPly + 1; i < pvLength[searchPly + 1]; i++)
+					pvTable[searchPly][i] = pvTable[searchPly + 1][i];
+				pvLength[searchPly] = pvLength[searchPly + 1];
+			}
 		}
 
-		// If a piece was captured, it has to be placed back in the board
-		if (lastMove.find("x") != std::string::npos) {
-			captured = true;
-			lastMove.erase(lastMove.find("x"), 1);
+		if (!currentMove.isCapture() && !currentMove.isPromotion())
+			quietsTried.push_back(currentMove);
+
+		// Young brothers wait: once the eldest brother has been searched without a cutoff, the other moves are shared with the idle threads
+		if (movesSearched == 1 && splitPoints && depth >= ybwcMinDepth && splitPoints->idle.load(std::memory_order_relaxed) > 0) {
+			SplitPoint sp(bitboard, history, ttMove, killers[searchPly][0], killers[searchPly][1]);
+			sp.eldest = currentMove;
+			sp.beta = beta;
+			sp.depth = depth;
+			sp.searchPly = searchPly;
+			sp.pvNode = pvNode;
+			sp.inCheck = inCheck;
+			sp.futile = futile;
+			sp.alpha = alpha;
+			sp.bestScore = bestScore;
+			sp.bestMove = nodeBestMove;
+			sp.movesSearched = movesSearched;
+			sp.quietsTried = quietsTried;
+			std::copy(pvTable[searchPly] + searchPly, pvTable[searchPly] + pvLength[searchPly], sp.pv + searchPly);
+			sp.pvLength = pvLength[searchPly];
+
+			splitSearch(sp);
+
+			if (stopped())
+				return 0;
+
+			bestScore = sp.bestScore;
+			nodeBestMove = sp.bestMove;
+			std::copy(sp.pv + searchPly, sp.pv + sp.pvLength, pvTable[searchPly] + searchPly);
+			pvLength[searchPly] = sp.pvLength;
+
+			if (bestScore >= beta) {
+				if (!nodeBestMove.isCapture() && !nodeBestMove.isPromotion()) {
+					storeKiller(nodeBestMove, searchPly);
+					history.update(bitboard.getSideToMove(), nodeBestMove, sp.quietsTried, depth, bitboard.getLastMove());
+				}
+				tt->store(key, depth, bLower, TranspositionTable::scoreToTT(bestScore, searchPly), nodeBestMove);
+				return bestScore;
+			}
+			break;
 		}
+	}
 
-		// Strings with the name of the squares used (source and destination)
-		std::string from = lastMove.substr(0, 2);
-		std::string to = lastMove.substr(2, 2);
+	// No legal moves: checkmate (the sooner the worse for the side to move) or stalemate
+	if (movesSearched == 0)
+		return MoveGenerator::getCheckers(bitboard) ? -(scoreMate - searchPly) : 0;
 
-		// Iterators of the respective square name
-		auto fromIt = std::find(mapPositions.begin(), mapPositions.end(), from);
-		auto toIt = std::find(mapPositions.begin(), mapPositions.end(), to);
+	tt->store(key, depth, nodeBestMove.isValid() ? bExact : bUpper, TranspositionTable::scoreToTT(bestScore, searchPly), nodeBestMove);
 
-		// Indexes of the respective square name
-		int fromIdx = std::distance(mapPositions.begin(), fromIt);
-		int toIdx = std::distance(mapPositions.begin(), toIt);
+	return bestScore;
+}
 
-		enumColor hasMoved = toMove == nWhite ? nBlack : nWhite;
 
-		// Updates bitboards
-		bitboard.resetBit(pieceType, toIdx);
-		bitboard.resetBit(hasMoved, toIdx);
-		bitboard.setBit(pieceType, fromIdx);
-		bitboard.setBit(hasMoved, fromIdx);
+/**
+ * @details Quiet moves that do not give check are skipped at futile nodes, except the first one. The first move is searched with the full window. Late quiet moves and losing captures
+ * are searched at a reduced depth with a null window first, and searched again at full depth if they beat alpha. The other moves are searched with a null window, and searched
+ * again with the full window if the score falls inside it.
+ */
+bool Engine::searchMove(Move mv, int moveCount, int alpha, int beta, int depth, int searchPly, bool pvNode, bool inCheck, bool futile, int &score) {
+	bool quiet = !mv.isCapture() && !mv.isPromotion();
 
-		// If is promotion
-		if (isalpha(lastMove.back()) && pieceType == nPawn) {
-			// Promote to queen by default
-			enumPiece promoteTo = nQueen;
+	// Quiet moves and losing captures searched late are unlikely to be the best moves
+	bool lateMove = features.lateMoveReductions && depth >= lmrMinDepth && moveCount >= (pvNode ? 3 : 1) && !inCheck
+					&& (quiet || (!mv.isPromotion() && !MoveGenerator::seeGE(bitboard, mv)));
 
-			if (lastMove.back() == 'n') promoteTo = nKnight;
-			else if (lastMove.back() == 'b') promoteTo = nBishop;
-			else if (lastMove.back() == 'r') promoteTo = nRook;
+	bitboard.doMove(mv);
+	bool givesCheck = MoveGenerator::getCheckers(bitboard).any();
 
-			bitboard.resetBit(promoteTo, toIdx);
-		}
+	if (futile && quiet && !givesCheck && moveCount > 0) {
+		bitboard.undoMove();
+		return false;
+	}
+
+	nodesVisited++;
 
-		// "Decaptures" a piece
-		if (captured) {
-			enumColor capturedPiece = captureHistory.top();
-			captureHistory.pop();
+	if ((nodesVisited & 2047) == 0)
+		checkTime();
+
+	if (moveCount == 0)
+		score = -search(-beta, -alpha, depth - 1, searchPly + 1, pvNode);
+	else {
+		int reduction = 0;
 
-			bitboard.setBit(toMove, toIdx);
-			bitboard.setBit(capturedPiece, toIdx);
+		if (lateMove && !givesCheck) {
+			reduction = lmrReductions[std::min(depth, 63)][std::min(moveCount + 1, 63)];
+			reduction -= pvNode;
+			reduction -= (mv == killers[searchPly][0] || mv == killers[searchPly][1]);
+			reduction = std::clamp(reduction, 0, depth - 2);
 		}
 
-		bitboard.updateBitboard();
+		score = -search(-alpha - 1, -alpha, depth - 1 - reduction, searchPly + 1, false);
 
-		toMove = hasMoved;
+		// A reduced move that beats alpha is searched again at full depth
+		if (reduction > 0 && score > alpha)
+			score = -search(-alpha - 1, -alpha, depth - 1, searchPly + 1, false);
 
-		--ply;
+		if (score > alpha && score < beta)
+			score = -search(-beta, -alpha, depth - 1, searchPly + 1, true);
 	}
+
+	bitboard.undoMove();
+
+	return true;
 }
 
 
 /**
- * @details Performs a recursive search on the moves tree using the minimax algorithm with alpha-beta pruning and returns the best move it has found
+ * @details Checks the split points from the one this thread works for up to the root, since a cutoff in any of them makes the work below it useless.
  */
-std::string Engine::getBestMove(int depth, enumColor color) {
-	std::string bestMove;
-	int nodesVisited = 0;
+bool Engine::stopped() const {
+	if (stopFlag->load(std::memory_order_relaxed))
+		return true;
 
-	auto begin = std::chrono::steady_clock::now();
+	for (const SplitPoint *sp = activeSplit; sp; sp = sp->parent)
+		if (sp->cutoff.load(std::memory_order_relaxed))
+			return true;
 
-	alphaBetaMax(intMin, intMax, depth, depth, color, nodesVisited, bestMove);
+	return false;
+}
 
-	auto end = std::chrono::steady_clock::now();
 
-	if (this->beVerbose) {
-		std::cout << "Best move found: " << bestMove << std::endl;
-		std::cout << "Nodes visited: " << nodesVisited << std::endl;
-		std::cout << "Time taken: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << " ms" << std::endl;
+/**
+ * @details The owner searches the moves of the split point like any other thread, and then waits for the threads still searching. It does not help other split points meanwhile.
+ * @ref https://www.chessprogramming.org/Young_Brothers_Wait_Concept
+ */
+void Engine::splitSearch(SplitPoint &sp) {
+	sp.parent = activeSplit;
+
+	{
+		std::lock_guard<std::mutex> lock(splitPoints->mutex);
+		splitPoints->open.push_back(&sp);
 	}
+	splitPoints->wakeUp.notify_all();
 
+	activeSplit = &sp;
+	splitLoop(sp);
+	activeSplit = sp.parent;
 
-	return bestMove;
+	closeSplitPoint(sp);
+
+	std::unique_lock<std::mutex> lock(splitPoints->mutex);
+	splitPoints->wakeUp.wait(lock, [&] { return sp.helpers == 0; });
 }
 
 
 /**
- * @details Minimax implementation
- * @ref https://en.wikipedia.org/wiki/Minimax <br>
- * https://en.wikipedia.org/wiki/Alpha%E2%80%93beta_pruning
+ * @details Moves are taken from the shared picker one at a time, with the current alpha of the node. A thread that finds a better move raises alpha and updates the line of the
+ * node. A thread that finds a cutoff sets the flag of the split point, which stops the searches of the other threads below it, and leaves the cutoff move and the quiet moves tried
+ * before it on the split point for the owner. Moves are numbered by the moves already searched, without the ones pruned, so late move reductions apply as in Engine::search.
  */
-int Engine::alphaBetaMax(int alpha, int beta, int depth, int depthLeft, enumColor color, int &nodesVisited, std::string &bestMove) {
-	if (depthLeft == 0)
-		return evaluateBoard(bitboard.getBitBoards(), color);
+void Engine::splitLoop(SplitPoint &sp) {
+	while (true) {
+		Move mv;
+		int moveCount, alpha;
+
+		{
+			std::lock_guard<std::mutex> lock(sp.mutex);
+			do
+				mv = sp.picker.nextMove();
+			while (mv.isValid() && mv == sp.eldest);
+			moveCount = sp.movesSearched;
+			alpha = sp.alpha;
+		}
 
-	auto allMoves = MoveGenerator::getPseudoLegalMoves(bitboard.getBitBoards(), color);
+		if (!mv.isValid() || stopped())
+			break;
 
-	auto rng = std::default_random_engine{};
-	std::shuffle(std::begin(allMoves), std::end(allMoves), rng);
+		int score;
+		if (!searchMove(mv, moveCount, alpha, sp.beta, sp.depth, sp.searchPly, sp.pvNode, sp.inCheck, sp.futile, score))
+			continue;
 
-	enumColor enemyColor = (color == nWhite) ? nBlack : nWhite;
+		if (stopped())
+			break;
 
-	for (auto &currentMove : allMoves) {
+		std::lock_guard<std::mutex> lock(sp.mutex);
 
-		nodesVisited++;
+		sp.movesSearched++;
 
-		makeMove(currentMove, false);
-		int score = alphaBetaMin(alpha, beta, depth, depthLeft - 1, enemyColor, nodesVisited, bestMove);
-		takeMove();
+		if (score > sp.bestScore) {
+			sp.bestScore = score;
 
-		if (score >= beta)
-			return beta;
-		if (score > alpha) {
-			alpha = score;
-			if (depth == depthLeft)
-				bestMove = currentMove;
-			//std::cout << "New move found for depth " << depth << " " << currentMove << " score: " << score << std::endl;
+			if (score > sp.alpha) {
+				sp.bestMove = mv;
+
+				// The owner updates the killer moves and the history, like for a cutoff in Engine::search
+				if (score >= sp.beta) {
+					sp.cutoff = true;
+					break;
+				}
+
+				sp.alpha = score;
+
+				sp.pv[sp.searchPly] = mv;
+				std::copy(pvTable[sp.searchPly + 1] + sp.searchPly + 1, pvTable[sp.searchPly + 1] + pvLength[sp.searchPly + 1], sp.pv + sp.searchPly + 1);
+				sp.pvLength = std::max(pvLength[sp.searchPly + 1], sp.searchPly + 1);
+			}
 		}
+
+		if (!mv.isCapture() && !mv.isPromotion())
+			sp.quietsTried.push_back(mv);
+	}
+
+	closeSplitPoint(sp);
+}
+
+
+void Engine::closeSplitPoint(SplitPoint &sp) {
+	std::lock_guard<std::mutex> lock(splitPoints->mutex);
+
+	if (sp.open) {
+		sp.open = false;
+		splitPoints->open.erase(std::find(splitPoints->open.begin(), splitPoints->open.end(), &sp));
 	}
-	return alpha;
 }
 
 
 /**
- * @details Minimax implementation
- * @ref https://en.wikipedia.org/wiki/Minimax <br>
- * https://en.wikipedia.org/wiki/Alpha%E2%80%93beta_pruning
+ * @details The newest split point is joined first: it is the deepest one of its owner, so it is the one most likely to still have work left when the helper is done with it.
  */
-int Engine::alphaBetaMin(int alpha, int beta, int depth, int depthLeft, enumColor color, int &nodesVisited, std::string &bestMove) {
+void Engine::ybwcHelperLoop() {
+	beVerbose = false;
+	nodesVisited = 0;
 
-	if (depthLeft == 0)
-		return -evaluateBoard(bitboard.getBitBoards(), color);
+	while (true) {
+		SplitPoint *sp;
 
-	auto allMoves = MoveGenerator::getPseudoLegalMoves(bitboard.getBitBoards(), color);
+		{
+			std::unique_lock<std::mutex> lock(splitPoints->mutex);
+			splitPoints->idle++;
+			splitPoints->wakeUp.wait(lock, [&] { return splitPoints->quit || !splitPoints->open.empty(); });
+			splitPoints->idle--;
 
-	auto rng = std::default_random_engine{};
-	std::shuffle(std::begin(allMoves), std::end(allMoves), rng);
+			if (splitPoints->quit)
+				return;
 
-	enumColor enemyColor = (color == nWhite) ? nBlack : nWhite;
+			sp = splitPoints->open.back();
+			sp->helpers++;
+		}
 
-	for (auto &currentMove : allMoves) {
+		bitboard = sp->position;
+		activeSplit = sp;
+		splitLoop(*sp);
+		activeSplit = nullptr;
 
-		nodesVisited++;
+		{
+			std::lock_guard<std::mutex> lock(splitPoints->mutex);
+			sp->helpers--;
+		}
+		splitPoints->wakeUp.notify_all();
+	}
+}
+
+
+/**
+ * @details Negamax search over captures and promotions only, so that positions are evaluated once they are quiet instead of in the middle of an exchange: <br>
+ * - stand pat: the side to move is assumed to be able to keep at least the static evaluation by not capturing, which gives a lower bound on the score <br>
+ * - delta pruning: captures that would not raise the score to alpha even when winning the captured piece plus a margin are skipped <br>
+ * - captures that lose material according to the static exchange evaluation are skipped <br>
+ * When in check, there is no stand pat and every evasion is searched, so mates at the horizon are found.
+ * @ref https://www.chessprogramming.org/Quiescence_Search
+ */
+int Engine::quiescence(int alpha, int beta, int searchPly) {
+	if (stopped())
+		return 0;
 
-		makeMove(currentMove, false);
-		int score = alphaBetaMax(alpha, beta, depth, depthLeft - 1, enemyColor, nodesVisited, bestMove);
-		takeMove();
+	enumColor us = bitboard.getSideToMove();
+	bool inCheck = MoveGenerator::getCheckers(bitboard).any();
+	int standPat = 0;
 
-		if (score <= alpha)
-			return alpha;
-		if (score < beta) {
-			beta = score;
-			//std::cout << "New move found for depth " << depth << " " << currentMove << " score: " << score << std::endl;
+	if (!inCheck || searchPly >= maxSearchPly - 1) {
+		standPat = evaluateBoard(bitboard.getBitBoards(), us);
+
+		if (standPat >= beta || searchPly >= maxSearchPly - 1)
+			return std::min(standPat, beta);
+		if (standPat > alpha)
+			alpha = standPat;
+	}
+
+	MovePicker picker(bitboard);
+	int movesSearched = 0;
+
+	for (Move currentMove = picker.nextMove(); currentMove.isValid(); currentMove = picker.nextMove()) {
+
+		if (!inCheck) {
+			enumPiece victim = (currentMove.getFlags() == fEnPassant) ? nPawn : bitboard.pieceOn(currentMove.getTo());
+
+			if (!currentMove.isPromotion() && standPat + pieceValue[victim] + deltaMargin <= alpha)
+				continue;
+
+			if (!MoveGenerator::seeGE(bitboard, currentMove))
+				continue;
 		}
+
+		nodesVisited++;
+		movesSearched++;
+
+		if ((nodesVisited & 2047) == 0)
+			checkTime();
+
+		bitboard.doMove(currentMove);
+		int score = -quiescence(-beta, -alpha, searchPly + 1);
+		bitboard.undoMove();
+
+		if (stopped())
+			return 0;
+
+		if (score >= beta)
+			return beta;
+		if (score > alpha)
+			alpha = score;
 	}
-	return beta;
+
+	// Checkmate. Stalemates are not detected, since quiet moves are not generated
+	if (inCheck && movesSearched == 0)
+		return -(scoreMate - searchPly);
+
+	return alpha;
+}
+
+
+/**
+ * @details Captures and promotions are already searched early, so only quiet moves are kept. The newest killer goes first and the oldest one is dropped.
+ */
+void Engine::storeKiller(Move mv, int searchPly) {
+	if (mv.isCapture() || mv.isPromotion() || killers[searchPly][0] == mv)
+		return;
+
+	killers[searchPly][1] = killers[searchPly][0];
+	killers[searchPly][0] = mv;
 }
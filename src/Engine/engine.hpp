@@ -3,11 +3,78 @@
 
 #include "bitboard.hpp"
 #include "movegen.hpp"
+#include "movepick.hpp"
+#include "tt.hpp"
+#include "timeman.hpp"
+#include "threadpool.hpp"
 
-#include <stack>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <string>
 
 namespace chessqdl {
 
+	/**
+	 * @brief Node whose moves are searched by several threads at once in modeYbwc. It is created by the thread that searched the first move of the node (the owner) and lives on its
+	 * stack until every thread that joined it is done. The fields that change during the search are guarded by SplitPoint::mutex
+	 */
+	struct SplitPoint {
+		Bitboard position;					// position of the node. Never changes, so threads copy it without locking
+		MoveHistory history;				// copy of the history of the owner, used to order the quiet moves
+		MovePicker picker;					// hands out the moves of the node to all threads
+		Move eldest;						// first move of the node, searched by the owner before the split
+		int beta = 0;						// upper bound of the node
+		int depth = 0;						// remaining depth of the node
+		int searchPly = 0;					// distance of the node from the root
+		bool pvNode = false;				// true if the node is searched with a full window
+		bool inCheck = false;				// true if the side to move is in check
+		bool futile = false;				// true if quiet moves are pruned by futility pruning
+		int alpha = 0;						// lower bound of the node, raised by the moves searched
+		int bestScore = 0;					// best score found so far
+		Move bestMove;						// move that raised alpha last, or that failed high (null if none)
+		int movesSearched = 0;				// moves searched so far, including the eldest. Moves pruned by futility pruning are not counted, as in Engine::search
+		MoveList quietsTried;				// quiet moves searched without a cutoff, whose history is lowered if another move fails high
+		Move pv[maxSearchPly];				// best line from the node, indexed like the rows of Engine::pvTable
+		int pvLength = 0;					// end of SplitPoint::pv
+		std::atomic<bool> cutoff{false};	// set when a move fails high, so that every thread searching the node stops
+		SplitPoint *parent = nullptr;		// split point the owner was working for (null if none)
+		int helpers = 0;					// threads other than the owner working on the node. Guarded by SplitPointList::mutex
+		bool open = true;					// threads may join the node. Guarded by SplitPointList::mutex
+		std::mutex mutex;
+
+		SplitPoint(const Bitboard &board, const MoveHistory &ownerHistory, Move ttMove, Move killer1, Move killer2)
+			: position(board), history(ownerHistory), picker(position, ttMove, killer1, killer2, &history) {}
+	};
+
+
+	/**
+	 * @brief Split points that idle threads can join, shared by all threads of a modeYbwc search
+	 */
+	struct SplitPointList {
+		std::mutex mutex;
+		std::condition_variable wakeUp;		// signaled when a split point opens, a thread leaves one, or the search ends
+		std::vector<SplitPoint *> open;		// split points that still have moves to hand out
+		std::atomic<int> idle{0};			// threads waiting for a split point
+		bool quit = false;					// set when the search ends
+	};
+
+
+	/**
+	 * @brief Selective search techniques that can be switched off one by one, to measure their effect on the time to reach a depth. All of them are enabled by default
+	 */
+	struct SearchFeatures {
+		bool nullMove = true;				// null move pruning
+		bool lateMoveReductions = true;		// late move reductions
+		bool reverseFutility = true;		// reverse futility pruning (static null move pruning)
+		bool futility = true;				// futility pruning of quiet moves
+		bool aspirationWindows = true;		// aspiration windows at the root
+	};
+
+
 	class Engine {
 
 	private:
@@ -17,26 +84,11 @@ namespace chessqdl {
 		 */
 		Bitboard bitboard;
 
-		/**
-		 * @brief Color of the pieces to move
-		 */
-		enumColor toMove = nWhite;
-
 		/**
 		 * @brief Color of the engine's pieces
 		 */
 		enumColor pieceColor;
 
-		/**
-		 * @brief Stack with moves history. Used to undo moves
-		 */
-		std::stack<std::string> moveHistory;
-
-		/**
-		 * @brief Stack with capture history. Used to undo captures
-		 */
-		std::stack<enumColor> captureHistory;
-
 		/**
 		 * @brief Ply counter. The counter is incremented after every valid move made and decremented after each undo
 		 */
@@ -57,11 +109,286 @@ namespace chessqdl {
 		 */
 		bool pvp = false;
 
+		/**
+		 * @brief Two quiet moves per search ply that recently caused a cutoff. They are tried right after the captures, since they are likely to cause a cutoff again in sibling nodes
+		 */
+		Move killers[maxSearchPly][2]{};
+
+		/**
+		 * @brief History and countermove tables used to order the quiet moves. Aged at the start of every search
+		 */
+		MoveHistory history;
+
+		/**
+		 * @brief Results of previous searches. Copies of the engine share the same table
+		 */
+		std::shared_ptr<TranspositionTable> tt = std::make_shared<TranspositionTable>();
+
+		/**
+		 * @brief Set to stop the search in progress. Copies of the engine share the same flag
+		 */
+		std::shared_ptr<std::atomic<bool>> stopFlag = std::make_shared<std::atomic<bool>>(false);
+
+		/**
+		 * @brief Clock of the engine. Updated after every move the engine makes
+		 */
+		SearchLimits limits;
+
+		/**
+		 * @brief Deadlines of the search in progress
+		 */
+		TimeManager timeManager;
+
+		/**
+		 * @brief Selective search techniques in use
+		 */
+		SearchFeatures features;
+
+		/**
+		 * @brief Number of threads used by the search, including the one calling Engine::getBestMove
+		 */
+		int threads = 1;
+
+		/**
+		 * @brief Size of the transposition table in megabytes. Engine::perft allocates a PerftTable of the same size
+		 */
+		size_t hashSize = TranspositionTable::defaultSize;
+
+		/**
+		 * @brief Private transposition tables of the root moves of a modeRootSplit search, which share Engine::hashSize between them. Every table only keeps the entries of the current
+		 * search, so the tables are reused by the next searches with as many root moves, until the hash size changes
+		 */
+		std::vector<std::shared_ptr<TranspositionTable>> rootSplitTables;
+
+		/**
+		 * @brief How the threads share the search
+		 */
+		enumSearchMode searchMode = modeLazySmp;
+
+		/**
+		 * @brief Open split points of the modeYbwc search in progress (null in other modes). Copies of the engine share the same list
+		 */
+		std::shared_ptr<SplitPointList> splitPoints;
+
+		/**
+		 * @brief Split point this thread is working for (null if none). Searches below it stop when it is cut off
+		 */
+		SplitPoint *activeSplit = nullptr;
+
+		/**
+		 * @brief Root searches of the search in progress that failed high on their aspiration window
+		 */
+		int aspirationFailHighs = 0;
+
+		/**
+		 * @brief Root searches of the search in progress that failed low on their aspiration window
+		 */
+		int aspirationFailLows = 0;
+
+		/**
+		 * @brief Null moves are not tried at nodes closer to the root than this ply. Raised while verifying a null move cutoff
+		 */
+		int nullMoveMinPly = 0;
+
+		/**
+		 * @brief Depth of the last iteration completed by the search in progress
+		 */
+		int completedDepth = 0;
+
+		/**
+		 * @brief Quantity of nodes visited by the search in progress
+		 */
+		long nodesVisited = 0;
+
+		/**
+		 * @brief Triangular PV table. Row i holds the best line found from the node at distance i from the root, starting at column i
+		 */
+		Move pvTable[maxSearchPly][maxSearchPly]{};
+
+		/**
+		 * @brief End of the line of each row of Engine::pvTable
+		 */
+		int pvLength[maxSearchPly]{};
+
+		/**
+		 * @brief Principal variation of the last completed iteration
+		 */
+		std::vector<Move> principalVariation;
+
 		/**
 		 * @brief Prints the current state of the board to stdout. A terminal with unicode support is recommended since the pieces are represented by unicode symbols
 		 */
 		void printBoard();
 
+
+		/**
+		 * @brief Builds the algebraic notation of \p mv, as printed to stdout when a move is made (e.g 1. Nb1c3, e4xd5)
+		 * @param mv  the move to be made. The notation must be built before the move is made on the board
+		 * @return string with the notation of the move
+		 */
+		std::string moveNotation(Move mv);
+
+
+		/**
+		 * @brief Checks if the player to move has been checkmated or stalemated, and prints the result if so
+		 * @return true if the game is over, false otherwise
+		 */
+		bool isGameOver();
+
+
+		/**
+		 * @brief Saves a move that caused a cutoff as a killer move of the given search ply
+		 * @param mv  the move that caused the cutoff
+		 * @param searchPly  distance from the root of the search
+		 */
+		void storeKiller(Move mv, int searchPly);
+
+
+		/**
+		 * @brief Margin of the delta pruning in the quiescence search, in pawns
+		 */
+		static constexpr int deltaMargin = 2;
+
+		/**
+		 * @brief Margin of the (reverse) futility pruning per ply of remaining depth, in pawns
+		 */
+		static constexpr int futilityMargin = 2;
+
+		/**
+		 * @brief Maximum remaining depth where the (reverse) futility pruning is applied
+		 */
+		static constexpr int futilityDepth = 3;
+
+		/**
+		 * @brief Minimum remaining depth where a null move is tried
+		 */
+		static constexpr int nullMoveMinDepth = 3;
+
+		/**
+		 * @brief Null move cutoffs are verified when the side to move has no more than this material besides pawns (in pawns), since zugzwang is common in such endgames
+		 */
+		static constexpr int zugzwangMaterial = 5;
+
+		/**
+		 * @brief Minimum remaining depth where late moves are reduced
+		 */
+		static constexpr int lmrMinDepth = 3;
+
+		/**
+		 * @brief First depth searched with an aspiration window. Scores of shallower iterations are too unstable for it
+		 */
+		static constexpr int aspirationMinDepth = 4;
+
+		/**
+		 * @brief Initial half width of the aspiration window, in pawns
+		 */
+		static constexpr int aspirationWindow = 1;
+
+		/**
+		 * @brief Minimum remaining depth of a split point in modeYbwc. Shallower nodes are too cheap to be worth sharing
+		 */
+		static constexpr int ybwcMinDepth = 4;
+
+
+		/**
+		 * @brief Returns true if the search of the current node must be abandoned: the search was stopped, or a split point this thread works for was cut off
+		 */
+		bool stopped() const;
+
+
+		/**
+		 * @brief Makes a move, searches it and takes it back. Applies the futility pruning, late move reductions and principal variation search of Engine::search
+		 * @param mv  move to be searched
+		 * @param moveCount  moves of the node searched before \p mv
+		 * @param alpha  lower bound of the node
+		 * @param beta  upper bound of the node
+		 * @param depth  remaining depth of the node
+		 * @param searchPly  distance of the node from the root
+		 * @param pvNode  true if the node is searched with a full window
+		 * @param inCheck  true if the side to move is in check
+		 * @param futile  true if quiet moves are pruned by futility pruning
+		 * @param score  score of the move, from the point of view of the side to move at the node
+		 * @return false if the move was pruned without being searched
+		 */
+		bool searchMove(Move mv, int moveCount, int alpha, int beta, int depth, int searchPly, bool pvNode, bool inCheck, bool futile, int &score);
+
+
+		/**
+		 * @brief Searches the root with a window around the score of the previous iteration, widening it until the score falls inside
+		 * @param depth  depth of the iteration
+		 * @param previousScore  score of the previous iteration
+		 * @return the score of the root, from the point of view of the side to move
+		 */
+		int aspirationSearch(int depth, int previousScore);
+
+
+		/**
+		 * @brief Iterative deepening loop of a helper thread of the Lazy SMP search. Reports nothing and runs until the shared stop flag is set
+		 * @param depth  maximum depth
+		 * @param id  index of the helper, starting at 1. Odd helpers skip the first depth, so that helpers search different depths at the same time
+		 */
+		void helperSearch(int depth, int id);
+
+
+		/**
+		 * @brief Searches every root move with the full window on the threads of \p pool, and keeps the best one in the first row of the PV table
+		 * @param depth  depth of the iteration
+		 * @param rootMoves  legal moves of the root
+		 * @param workers  one engine per root move, with the move already made, that searches it in every iteration
+		 * @param pool  threads that search the root moves
+		 * @return the score of the root, from the point of view of the side to move
+		 */
+		int rootSplitSearch(int depth, const MoveList &rootMoves, std::vector<Engine> &workers, ThreadPool &pool);
+
+
+		/**
+		 * @brief Opens \p sp to idle threads, searches its moves along with them and returns when all of them are done
+		 * @param sp  split point owned by this thread
+		 */
+		void splitSearch(SplitPoint &sp);
+
+
+		/**
+		 * @brief Takes moves from \p sp and searches them until there are none left or the node is cut off
+		 * @param sp  split point this thread works for
+		 */
+		void splitLoop(SplitPoint &sp);
+
+
+		/**
+		 * @brief Removes \p sp from the open split points, so that no more threads join it
+		 */
+		void closeSplitPoint(SplitPoint &sp);
+
+
+		/**
+		 * @brief Main loop of a helper thread of the modeYbwc search: waits for a split point, joins it, and starts again until the search ends
+		 */
+		void ybwcHelperLoop();
+
+
+		/**
+		 * @brief Searches captures and promotions until the position is quiet
+		 * @param alpha  lower bound of the score
+		 * @param beta  upper bound of the score
+		 * @param searchPly  distance from the root of the search
+		 * @return the score of the position from the point of view of the side to move
+		 */
+		int quiescence(int alpha, int beta, int searchPly);
+
+
+		/**
+		 * @brief Stops the search if its hard time limit was reached. Called from within the search
+		 */
+		void checkTime();
+
+
+		/**
+		 * @brief Updates the engine's clock after it has made a move
+		 * @param usedTime  time the move took, in milliseconds
+		 */
+		void updateClock(int usedTime);
+
 	public:
 
 
@@ -86,12 +413,29 @@ namespace chessqdl {
 		void parser();
 
 
+		/**
+		 * @brief Counts the leaf nodes of the tree of legal moves of the current position (see Perft) on every thread of the engine, with a PerftTable as large as the transposition
+		 * table, and prints the count, the time taken and the nodes per second
+		 * @param depth  depth of the tree. Negative depths are rejected
+		 * @param divide  also prints the count of every root move
+		 */
+		void perft(int depth, bool divide = false);
+
+
 		/**
 		 * @brief Effectively makes a move (only if \p mv represents a valid move), updates the bitboards and prints to stdout the move made (if \p verbose)
-		 * @param mv  string with move to be made
+		 * @param mv  string with move to be made (e.g e2e4, e7e8q)
+		 * @param verbose  sets whether or not the movement made should be printed to stdout. Defaults to true
+		 */
+		void makeMove(const std::string &mv, bool verbose = true);
+
+
+		/**
+		 * @brief Makes a move without validating it with Bitboard::doMove and prints to stdout the move made (if \p verbose)
+		 * @param mv  move to be made. Must be one of the moves given by the move generator for the current position
 		 * @param verbose  sets whether or not the movement made should be printed to stdout. Defaults to true
 		 */
-		void makeMove(std::string mv, bool verbose = true);
+		void makeMove(Move mv, bool verbose = true);
 
 
 		/**
@@ -102,7 +446,7 @@ namespace chessqdl {
 
 		/**
 		 * @brief Get method that returns the color of the player to make a move
-		 * @return the value of Engine::toMove
+		 * @return the color of the pieces to move on the current board
 		 */
 		enumColor getToMove();
 
@@ -115,43 +459,86 @@ namespace chessqdl {
 
 
 		/**
-		 * @brief Traverses the tree of movements up to \p depth and returns the best move the algorithm has found
-		 * @param board  current board state
-		 * @param depth  maximum traversal depth
-		 * @param color  color of the pieces for which to find the best move
-		 * @return
+		 * @brief Sets the size of the transposition table
+		 * @param megabytes  size of the table in megabytes
 		 */
-		std::string getBestMove(int depth, enumColor color);
+		void setHashSize(size_t megabytes);
 
 
 		/**
-		 * @brief Max implementation of the Minimax algorithm with alpha-beta pruning
-		 * @param board  current board state
-		 * @param alpha  score to be maximized
-		 * @param beta  score to be minimized
-		 * @param depth  maximum traversal depth
-		 * @param depthLeft  how far the algorithm is from reaching the max depth.
-		 * @param color  color of the moving pieces
-		 * @param nodesVisited  quantity of nodes visited
-		 * @param bestMove  best move the algorithm has found
-		 * @return returns the value of \p alpha
+		 * @brief Sets the number of threads used by the search
+		 * @param n  number of threads, at least 1
+		 */
+		void setThreads(int n);
+
+
+		/**
+		 * @brief Sets how the threads share the search
+		 * @param mode  Lazy SMP, root move splitting or Young Brothers Wait Concept
+		 */
+		void setSearchMode(enumSearchMode mode);
+
+
+		/**
+		 * @brief Sets the clock of the engine. Searches stop according to it, besides the maximum depth
+		 * @param newLimits  time left, increment, moves to go and time per move
 		 */
-		int alphaBetaMax(int alpha, int beta, int depth, int depthLeft, enumColor color, int &nodesVisited, std::string &bestMove);
+		void setLimits(const SearchLimits &newLimits);
 
 
 		/**
-		 * @brief Min implementation of the Minimax algorithm with alpha-beta pruning
+		 * @brief Switches the selective search techniques on or off
+		 * @param newFeatures  techniques to be used
+		 */
+		void setFeatures(const SearchFeatures &newFeatures);
+
+
+		/**
+		 * @brief Traverses the tree of movements with increasing depths up to \p depth and returns the best move the algorithm has found
 		 * @param board  current board state
-		 * @param alpha  score to be maximized
-		 * @param beta  score to be minimized
 		 * @param depth  maximum traversal depth
-		 * @param depthLeft  how far the algorithm is from reaching the max depth.
-		 * @param color  color of the moving pieces
-		 * @param nodesVisited  quantity of nodes visited
-		 * @param bestMove  best move the algorithm has found
-		 * @return returns the value of \p beta
+		 * @param color  color of the pieces for which to find the best move. Must be the side to move
+		 * @return the best move found, or a null move if \p color is not the side to move
+		 */
+		Move getBestMove(int depth, enumColor color);
+
+
+		/**
+		 * @brief Stops the search in progress, which then returns the best move of its last completed iteration. Can be called from any thread
+		 */
+		void stop();
+
+
+		/**
+		 * @brief Returns the principal variation of the last completed iteration of the last search
+		 * @param maxLength  maximum amount of moves
+		 * @return the sequence of best moves for both sides, starting from the current position
+		 */
+		std::vector<Move> getPrincipalVariation(int maxLength);
+
+
+		/**
+		 * @brief Returns the quantity of nodes visited by the last search
+		 */
+		long getNodesVisited() const;
+
+
+		/**
+		 * @brief Converts a score to the text printed in the search reports (e.g 3, mate 2)
+		 */
+		static std::string scoreToString(int score);
+
+
+		/**
+		 * @brief Principal variation search with alpha-beta pruning (negamax)
+		 * @param alpha  lower bound of the score
+		 * @param beta  upper bound of the score
+		 * @param depth  remaining depth. The quiescence search starts when it reaches 0
+		 * @param searchPly  distance from the root of the search
+		 * @param pvNode  true if the node is searched with a full window, as part of the principal variation
+		 * @return the score of the position from the point of view of the side to move
 		 */
-		int alphaBetaMin(int alpha, int beta, int depth, int depthLeft, enumColor color, int &nodesVisited, std::string &bestMove);
+		int search(int alpha, int beta, int depth, int searchPly, bool pvNode);
 
     };
 
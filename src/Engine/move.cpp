@@ -0,0 +1,16 @@
+#include "move.hpp"
+
+using namespace chessqdl;
+
+
+/**
+ * @details Concatenates the name of the origin and destination squares. Promotions are followed by the lower case letter of the new piece.
+ */
+std::string Move::toString() const {
+	std::string str = mapPositions[getFrom()] + mapPositions[getTo()];
+
+	if (isPromotion())
+		str += "nbrq"[getFlags() & 3];
+
+	return str;
+}
@@ -0,0 +1,198 @@
+#ifndef CHESSQDL_MOVE_HPP
+#define CHESSQDL_MOVE_HPP
+
+#include "const.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+
+namespace chessqdl {
+
+	/**
+	 * @brief Special move flags, stored in the 4 most significant bits of a Move. Bit 2 marks captures and bit 3 marks promotions
+	 * @ref https://www.chessprogramming.org/Encoding_Moves
+	 */
+	enum enumMoveFlag {
+		fQuiet = 0,				// quiet move
+		fDoublePush = 1,		// pawn moving two squares from its initial rank
+		fKingCastle = 2,		// castle on the king side
+		fQueenCastle = 3,		// castle on the queen side
+		fCapture = 4,			// any capture
+		fEnPassant = 5,			// en passant capture
+		fPromotion = 8,			// promotion to knight. fPromotion + 1, + 2 and + 3 are promotions to bishop, rook and queen
+		fPromoCapture = 12		// capture with promotion to knight. Same layout as fPromotion
+	};
+
+
+	/**
+	 * @brief Compact representation of a move. Origin square, destination square and special flags are packed in 16 bits: <br>
+	 * bits 0-5   destination square <br>
+	 * bits 6-11  origin square <br>
+	 * bits 12-15 flags (see enumMoveFlag) <br>
+	 *
+	 * A default constructed Move (all bits zero) does not represent any valid move and is used as a null value.
+	 */
+	class Move {
+
+	private:
+
+		/**
+		 * @brief Packed move
+		 */
+		uint16_t data;
+
+	public:
+
+		/**
+		 * @brief Default constructor. Creates a null move
+		 */
+		constexpr Move() : data(0) {}
+
+		/**
+		 * @brief Creates a move from \p from to \p to with the given \p flags
+		 * @param from  index of the origin square
+		 * @param to  index of the destination square
+		 * @param flags  special move flags (see enumMoveFlag)
+		 */
+		constexpr Move(int from, int to, int flags = fQuiet) : data(uint16_t((flags & 0xf) << 12 | (from & 0x3f) << 6 | (to & 0x3f))) {}
+
+		/**
+		 * @brief Returns the index of the origin square
+		 */
+		constexpr int getFrom() const { return (data >> 6) & 0x3f; }
+
+		/**
+		 * @brief Returns the index of the destination square
+		 */
+		constexpr int getTo() const { return data & 0x3f; }
+
+		/**
+		 * @brief Returns the special move flags (see enumMoveFlag)
+		 */
+		constexpr int getFlags() const { return data >> 12; }
+
+		/**
+		 * @brief Returns the raw 16 bits representation of the move
+		 */
+		constexpr uint16_t getRaw() const { return data; }
+
+		/**
+		 * @brief Returns true if the move captures a piece (including en passant and capture promotions)
+		 */
+		constexpr bool isCapture() const { return getFlags() & fCapture; }
+
+		/**
+		 * @brief Returns true if the move is a pawn promotion
+		 */
+		constexpr bool isPromotion() const { return getFlags() & fPromotion; }
+
+		/**
+		 * @brief Returns the piece a pawn is promoted to. Only meaningful if isPromotion() is true
+		 */
+		constexpr enumPiece getPromotion() const { return enumPiece(nKnight + (getFlags() & 3)); }
+
+		/**
+		 * @brief Returns true if this is not the null move
+		 */
+		constexpr bool isValid() const { return data != 0; }
+
+		constexpr bool operator==(const Move &other) const { return data == other.data; }
+
+		constexpr bool operator!=(const Move &other) const { return data != other.data; }
+
+		/**
+		 * @brief Converts the move to the notation used by the player interface (e.g e2e4, e7e8q)
+		 * @return string representing the move
+		 */
+		std::string toString() const;
+
+	};
+
+
+	/**
+	 * @brief Fixed capacity list of moves with inline storage. The move generator fills it in place, so generating moves does not allocate memory on the heap.
+	 * A chess position has at most 218 legal moves, so 256 entries are enough for any list of moves of a single color.
+	 */
+	class MoveList {
+
+	public:
+
+		/**
+		 * @brief Maximum number of moves the list can hold
+		 */
+		static constexpr int capacity = 256;
+
+	private:
+
+		/**
+		 * @brief Inline storage of the moves
+		 */
+		Move moves[capacity];
+
+		/**
+		 * @brief Number of moves in the list
+		 */
+		int count = 0;
+
+	public:
+
+		/**
+		 * @brief Appends \p mv to the end of the list
+		 */
+		void push_back(Move mv) {
+			assert(count < capacity);
+			moves[count++] = mv;
+		}
+
+		/**
+		 * @brief Constructs a move at the end of the list
+		 */
+		template<typename... Args>
+		void emplace_back(Args... args) {
+			assert(count < capacity);
+			moves[count++] = Move(args...);
+		}
+
+		/**
+		 * @brief Removes all moves from the list
+		 */
+		void clear() { count = 0; }
+
+		/**
+		 * @brief Returns the number of moves in the list
+		 */
+		int size() const { return count; }
+
+		/**
+		 * @brief Returns true if there are no moves in the list
+		 */
+		bool empty() const { return count == 0; }
+
+		/**
+		 * @brief Returns true if \p mv is in the list
+		 */
+		bool contains(Move mv) const {
+			for (int i = 0; i < count; i++)
+				if (moves[i] == mv)
+					return true;
+			return false;
+		}
+
+		Move &operator[](int i) { return moves[i]; }
+
+		const Move &operator[](int i) const { return moves[i]; }
+
+		Move *begin() { return moves; }
+
+		Move *end() { return moves + count; }
+
+		const Move *begin() const { return moves; }
+
+		const Move *end() const { return moves + count; }
+
+	};
+
+}
+
+#endif //CHESSQDL_MOVE_HPP
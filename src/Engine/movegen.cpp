@@ -1,13 +1,186 @@
 #include "movegen.hpp"
 #include "bitboard.hpp"
 #include "utils.hpp"
+#include "attacks.hpp"
 
-#include <cmath>
+#include <algorithm>
+#include <cassert>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CHESSQDL_HAS_PEXT
+#endif
 
 
 using namespace chessqdl;
 
 
+namespace {
+
+	/**
+	 * @brief Magic bitboard entry of a square. The relevant occupancy (pieces that may block the slider) is multiplied by the magic number, and the most significant bits of the product
+	 * index the attacks of the square
+	 * @ref https://www.chessprogramming.org/Magic_Bitboards
+	 */
+	struct Magic {
+		U64 mask;				// relevant occupancy: the empty board attacks of the square, without the board edges
+		uint64_t magic;			// magic number that maps every relevant occupancy to an index without destructive collisions
+		U64 *attacks;			// first entry of the square on the attack table
+		U64 *pextAttacks;		// first entry of the square on the PEXT attack table
+		int shift;				// 64 minus the number of bits of the index
+
+		unsigned index(U64 occupancy) const {
+			return unsigned(((occupancy & mask).to_ullong() * magic) >> shift);
+		}
+	};
+
+	Magic bishopMagics[64];
+	Magic rookMagics[64];
+
+	// Attack tables shared by all squares ("fancy" magic bitboards). Sizes are the sums of 2^(relevant bits) over all squares
+	U64 bishopTable[0x1480];
+	U64 rookTable[0x19000];
+
+	// Same tables, indexed by the relevant occupancy bits extracted with PEXT
+	U64 bishopPextTable[0x1480];
+	U64 rookPextTable[0x19000];
+
+	enumSliderBackend sliderBackend = backendMagic;
+
+
+#ifdef CHESSQDL_HAS_PEXT
+	/**
+	 * @brief Loads the attacks of a slider from the PEXT table. Compiled for BMI2 regardless of the build flags, so it must only be called if the CPU supports it
+	 */
+	__attribute__((target("bmi2")))
+	U64 pextAttacks(const Magic &m, U64 occupancy) {
+		return m.pextAttacks[_pext_u64(occupancy.to_ullong(), m.mask.to_ullong())];
+	}
+#endif
+
+
+	/**
+	 * @brief Computes slider attacks by walking each ray until it leaves the board or hits a piece. Slow, only used to fill the tables
+	 * @param directions  the four directions of the slider as {file, rank} steps
+	 */
+	U64 slidingAttacks(const int directions[4][2], int idx, U64 occupancy) {
+		U64 attacks;
+
+		for (int d = 0; d < 4; d++) {
+			int file = idx % 8 + directions[d][0];
+			int rank = idx / 8 + directions[d][1];
+
+			while (file >= 0 && file < 8 && rank >= 0 && rank < 8) {
+				attacks.set(rank * 8 + file);
+				if (occupancy.test(rank * 8 + file))
+					break;
+				file += directions[d][0];
+				rank += directions[d][1];
+			}
+		}
+
+		return attacks;
+	}
+
+
+	/**
+	 * @brief Magic numbers of each square. They were found by trying sparse pseudo-random numbers (xorshift64*) until one mapped every relevant occupancy of the square to an entry
+	 * with the right attacks. The index of a bishop uses at most 9 bits and the index of a rook at most 12.
+	 */
+	const uint64_t bishopMagicNumbers[64] = {
+		0x40106000a1160020ULL, 0x0020010250810120ULL, 0x2010010220280081ULL, 0x002806004050c040ULL,
+		0x0002021018000000ULL, 0x2001112010000400ULL, 0x0881010120218080ULL, 0x1030820110010500ULL,
+		0x0000120222042400ULL, 0x2000020404040044ULL, 0x8000480094208000ULL, 0x0003422a02000001ULL,
+		0x000a220210100040ULL, 0x8004820202226000ULL, 0x0018234854100800ULL, 0x0100004042101040ULL,
+		0x0004001004082820ULL, 0x0010000810010048ULL, 0x1014004208081300ULL, 0x2080818802044202ULL,
+		0x0040880c00a00100ULL, 0x0080400200522010ULL, 0x0001000188180b04ULL, 0x0080249202020204ULL,
+		0x1004400004100410ULL, 0x00013100a0022206ULL, 0x2148500001040080ULL, 0x4241080011004300ULL,
+		0x4020848004002000ULL, 0x10101380d1004100ULL, 0x0008004422020284ULL, 0x01010a1041008080ULL,
+		0x0808080400082121ULL, 0x0808080400082121ULL, 0x0091128200100c00ULL, 0x0202200802010104ULL,
+		0x8c0a020200440085ULL, 0x01a0008080b10040ULL, 0x0889520080122800ULL, 0x100902022202010aULL,
+		0x04081a0816002000ULL, 0x0000681208005000ULL, 0x8170840041008802ULL, 0x0a00004200810805ULL,
+		0x0830404408210100ULL, 0x2602208106006102ULL, 0x1048300680802628ULL, 0x2602208106006102ULL,
+		0x0602010120110040ULL, 0x0941010801043000ULL, 0x000040440a210428ULL, 0x0008240020880021ULL,
+		0x0400002012048200ULL, 0x00ac102001210220ULL, 0x0220021002009900ULL, 0x84440c080a013080ULL,
+		0x0001008044200440ULL, 0x0004c04410841000ULL, 0x2000500104011130ULL, 0x1a0c010011c20229ULL,
+		0x0044800112202200ULL, 0x0434804908100424ULL, 0x0300404822c08200ULL, 0x48081010008a2a80ULL
+	};
+
+	const uint64_t rookMagicNumbers[64] = {
+		0x0880004000108025ULL, 0x8040004010002008ULL, 0x2080200010008008ULL, 0x1100100008210004ULL,
+		0xc200209084020008ULL, 0x2100010004000208ULL, 0x0400081000822421ULL, 0x0200010422048844ULL,
+		0x0800800080400024ULL, 0x0001402000401000ULL, 0x3000801000802001ULL, 0x4400800800100083ULL,
+		0x0904802402480080ULL, 0x4040800400020080ULL, 0x0018808042000100ULL, 0x4040800080004100ULL,
+		0x0040048001458024ULL, 0x00a0004000205000ULL, 0x3100808010002000ULL, 0x4825010010000820ULL,
+		0x5004808008000401ULL, 0x2024818004000a00ULL, 0x0005808002000100ULL, 0x2100060004806104ULL,
+		0x0080400880008421ULL, 0x4062220600410280ULL, 0x010a004a00108022ULL, 0x0000100080080080ULL,
+		0x0021000500080010ULL, 0x0044000202001008ULL, 0x0000100400080102ULL, 0xc020128200040545ULL,
+		0x0080002000400040ULL, 0x0000804000802004ULL, 0x0000120022004080ULL, 0x010a386103001001ULL,
+		0x9010080080800400ULL, 0x8440020080800400ULL, 0x0004228824001001ULL, 0x000000490a000084ULL,
+		0x0080002000504000ULL, 0x200020005000c000ULL, 0x0012088020420010ULL, 0x0010010080080800ULL,
+		0x0085001008010004ULL, 0x0002000204008080ULL, 0x0040413002040008ULL, 0x0000304081020004ULL,
+		0x0080204000800080ULL, 0x3008804000290100ULL, 0x1010100080200080ULL, 0x2008100208028080ULL,
+		0x5000850800910100ULL, 0x8402019004680200ULL, 0x0120911028020400ULL, 0x0000008044010200ULL,
+		0x0020850200244012ULL, 0x0020850200244012ULL, 0x0000102001040841ULL, 0x140900040a100021ULL,
+		0x000200282410a102ULL, 0x000200282410a102ULL, 0x000200282410a102ULL, 0x4048240043802106ULL
+	};
+
+
+	/**
+	 * @brief Fills the attack tables of a slider. For every square, all subsets of the relevant occupancy are enumerated (Carry-Rippler) and their attacks are stored at the
+	 * index given by the magic number and at the index given by PEXT.
+	 */
+	void initMagics(const int directions[4][2], const uint64_t magicNumbers[64], U64 *table, U64 *pextTable, Magic magics[64]) {
+		const U64 edgeRanks = U64(0xffL) | U64(0xffL << 56);
+		const U64 edgeFiles = ~notAFile | ~notHFile;
+
+		int size = 0;
+
+		for (int idx = 0; idx < 64; idx++) {
+			Magic &m = magics[idx];
+
+			// Pieces on the edges never block the slider, unless the slider is on that edge
+			U64 edges = (edgeRanks & ~(U64(0xffL) << (idx / 8 * 8))) | (edgeFiles & ~(U64(0x0101010101010101L) << (idx % 8)));
+			m.mask = slidingAttacks(directions, idx, 0) & ~edges;
+			m.magic = magicNumbers[idx];
+			m.shift = 64 - m.mask.count();
+			m.attacks = (idx == 0) ? table : magics[idx - 1].attacks + size;
+			m.pextAttacks = (idx == 0) ? pextTable : magics[idx - 1].pextAttacks + size;
+
+			// Enumerates every subset of the mask
+			uint64_t b = 0;
+			size = 0;
+			do {
+				U64 attacks = slidingAttacks(directions, idx, b);
+				unsigned index = m.index(b);
+
+				// Different occupancies may only share an entry if they have the same attacks
+				assert(m.attacks[index].none() || m.attacks[index] == attacks);
+				m.attacks[index] = attacks;
+
+				// Subsets are enumerated in increasing order, which is also the order of their PEXT indexes
+				m.pextAttacks[size] = attacks;
+
+				size++;
+				b = (b - m.mask.to_ullong()) & m.mask.to_ullong();
+			} while (b);
+		}
+	}
+
+	const int bishopDirections[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+	const int rookDirections[4][2] = {{0, 1}, {0, -1}, {1, 0}, {-1, 0}};
+
+	// Fills the tables during static initialization, before any move is generated
+	const bool magicsInitialized = [] {
+		initMagics(bishopDirections, bishopMagicNumbers, bishopTable, bishopPextTable, bishopMagics);
+		initMagics(rookDirections, rookMagicNumbers, rookTable, rookPextTable, rookMagics);
+		MoveGenerator::setSliderBackend(backendAuto);
+		return true;
+	}();
+
+}
+
+
 /**
  * @details shifts bitboard northwest. E.g
  * 0 0 0	1 0 0
@@ -375,9 +548,86 @@ U64 MoveGenerator::getQueenMoves(const BitbArray &bitboard, enumColor color) {
 
 
 /**
- * @details Identifies all pawns that can promote on next move and generates a list with all possible promotions. Also removes the option to just move without promoting
+ * @details Multiplies the relevant occupancy by the magic number of the square and loads the attacks from the bishop table. With the PEXT backend, the relevant occupancy bits are
+ * extracted with PEXT and used as index instead.
+ */
+U64 MoveGenerator::bishopAttacks(int idx, U64 occupancy) {
+	const Magic &m = bishopMagics[idx];
+#ifdef CHESSQDL_HAS_PEXT
+	if (sliderBackend == backendPext)
+		return pextAttacks(m, occupancy);
+#endif
+	return m.attacks[m.index(occupancy)];
+}
+
+
+/**
+ * @details Multiplies the relevant occupancy by the magic number of the square and loads the attacks from the rook table. With the PEXT backend, the relevant occupancy bits are
+ * extracted with PEXT and used as index instead.
+ */
+U64 MoveGenerator::rookAttacks(int idx, U64 occupancy) {
+	const Magic &m = rookMagics[idx];
+#ifdef CHESSQDL_HAS_PEXT
+	if (sliderBackend == backendPext)
+		return pextAttacks(m, occupancy);
+#endif
+	return m.attacks[m.index(occupancy)];
+}
+
+
+/**
+ * @details Union of bishop and rook attacks.
+ */
+U64 MoveGenerator::queenAttacks(int idx, U64 occupancy) {
+	return bishopAttacks(idx, occupancy) | rookAttacks(idx, occupancy);
+}
+
+
+/**
+ * @details Queries CPUID through the compiler builtins. The CPU model is initialized explicitly because this may run during static initialization.
+ */
+bool MoveGenerator::isPextSupported() {
+#ifdef CHESSQDL_HAS_PEXT
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("bmi2");
+#else
+	return false;
+#endif
+}
+
+
+/**
+ * @details AMD processors before Zen 3 implement PEXT in microcode, making it slower than a multiplication. On those, backendAuto picks magic bitboards even though PEXT is available.
+ */
+bool MoveGenerator::setSliderBackend(enumSliderBackend backend) {
+	bool supported = isPextSupported();
+
+	if (backend == backendAuto) {
+#ifdef CHESSQDL_HAS_PEXT
+		supported = supported && !__builtin_cpu_is("znver1") && !__builtin_cpu_is("znver2");
+#endif
+		sliderBackend = supported ? backendPext : backendMagic;
+		return true;
+	}
+
+	sliderBackend = (backend == backendPext && supported) ? backendPext : backendMagic;
+	return backend != backendPext || supported;
+}
+
+
+/**
+ * @details Returns the backend in use.
  */
-std::vector<std::string> MoveGenerator::getPawnPromotions(U64 &pawnMoves, uint64_t fromPos) {
+enumSliderBackend MoveGenerator::getSliderBackend() {
+	return sliderBackend;
+}
+
+
+/**
+ * @details Identifies all pawns that can promote on next move and adds all possible promotions to \p moves. Also removes the option to just move without promoting.
+ * Since pawns only change files when capturing, a promotion to another file is flagged as a capture.
+ */
+void MoveGenerator::getPawnPromotions(U64 &pawnMoves, uint64_t fromPos, MoveList &moves) {
 	U64 whitePromotions = pawnMoves & U64(0xffL << 56); // White pawn moves that are promotions
 	U64 blackPromotions = pawnMoves & U64(0xffL); // Black pawn moves that are promotions
 
@@ -385,126 +635,491 @@ std::vector<std::string> MoveGenerator::getPawnPromotions(U64 &pawnMoves, uint64
 	pawnMoves ^= whitePromotions;
 	pawnMoves ^= blackPromotions;
 
-	// Promotions as uint64_t
-	uint64_t uWhitePromotions = whitePromotions.to_ullong();
-	uint64_t uBlackPromotions = blackPromotions.to_ullong();
-
-	int i;
-	uint64_t toPos;
-	std::string move;
-	std::vector<std::string> promotions;
-
-	while (uWhitePromotions) {
-		i = leastSignificantSetBit(uWhitePromotions);
-		toPos = 1L << i;
-		uWhitePromotions ^= toPos;
-		move = moveName(fromPos, toPos);
-		promotions.push_back(move + "n"); // Promote to Knight
-		promotions.push_back(move + "b"); // Promote to Bishop
-		promotions.push_back(move + "r"); // Promote to Rook
-		promotions.push_back(move + "q"); // Promote to Queen
+	U64 promotions = whitePromotions | blackPromotions;
+
+	int from = leastSignificantSetBit(fromPos);
+	int to, flags;
+
+	while (promotions) {
+		to = promotions.popLsb();
+		flags = (to % 8 != from % 8) ? fPromoCapture : fPromotion;
+		moves.emplace_back(from, to, flags);			// Promote to Knight
+		moves.emplace_back(from, to, flags + 1);		// Promote to Bishop
+		moves.emplace_back(from, to, flags + 2);		// Promote to Rook
+		moves.emplace_back(from, to, flags + 3);		// Promote to Queen
 	}
+}
 
-	while (uBlackPromotions) {
-		i = leastSignificantSetBit(uBlackPromotions);
-		toPos = 1l << i;
-		uBlackPromotions ^= toPos;
-		move = moveName(fromPos, toPos);
-		promotions.push_back(move + "n"); // Promote to Knight
-		promotions.push_back(move + "b"); // Promote to Bishop
-		promotions.push_back(move + "r"); // Promote to Rook
-		promotions.push_back(move + "q"); // Promote to Queen
+
+/**
+ * @details Non-sliding pieces read their attacks from the precomputed tables and sliding pieces are looked up with MoveGenerator::bishopAttacks and MoveGenerator::rookAttacks.
+ * Pawns move forward to empty squares (twice from their initial rank) and only attack enemy pieces.
+ */
+U64 MoveGenerator::getPieceMoves(const BitbArray &bitboard, int k, int idx, enumColor color) {
+	U64 notAlly = ~bitboard[color];
+
+	switch (k) {
+		case nPawn: {
+			U64 empty = ~bitboard[nColor];
+			U64 pawn = U64(1) << idx;
+			U64 attacks = pawnAttacks[color][idx] & bitboard[color == nWhite ? nBlack : nWhite];
+
+			if (color == nWhite) {
+				U64 push = shiftNorth(pawn) & empty;
+				return attacks | push | (shiftNorth(push & U64(0xffL << 16)) & empty);
+			} else {
+				U64 push = shiftSouth(pawn) & empty;
+				return attacks | push | (shiftSouth(push & U64(0xffL << 40)) & empty);
+			}
+		}
+		case nKnight:
+			return knightAttacks[idx] & notAlly;
+		case nBishop:
+			return bishopAttacks(idx, bitboard[nColor]) & notAlly;
+		case nRook:
+			return rookAttacks(idx, bitboard[nColor]) & notAlly;
+		case nQueen:
+			return queenAttacks(idx, bitboard[nColor]) & notAlly;
+		default:
+			return kingAttacks[idx] & notAlly;
 	}
+}
 
-	return promotions;
+
+/**
+ * @details Pawn moves to the last rank are expanded into the four promotions. The other moves are flagged as captures when the destination holds an enemy piece and as double pushes when a
+ * pawn moves two ranks.
+ */
+void MoveGenerator::addMoves(const BitbArray &bitboard, int k, int from, U64 pieceMoves, enumColor color, MoveList &moves) {
+	U64 enemies = bitboard[color == nWhite ? nBlack : nWhite];
+
+	if (k == nPawn)
+		getPawnPromotions(pieceMoves, 1L << from, moves);
+
+	// Loops through all possible moves that the piece of type k at the from position can make and adds it to the list of moves
+	while (pieceMoves) {
+		int to = pieceMoves.popLsb();
+
+		if (enemies.test(to))
+			moves.emplace_back(from, to, fCapture);
+		else if (k == nPawn && (to - from == 16 || from - to == 16))
+			moves.emplace_back(from, to, fDoublePush);
+		else
+			moves.emplace_back(from, to, fQuiet);
+	}
 }
 
 
 /**
- * @details Iterates through all bitboards (from nPawn to nKing) generating moves for pieces one at a time. If there are 16 pawns on the board, this method will generate pawn moves 16 times, one for each individual pawn.
- * It does so for every type of piece on the board, and then returns a list with strings of all possible moves it has found.
+ * @details Iterates through all bitboards (from nPawn to nKing) generating moves for pieces one at a time, reading the attack tables of each piece.
+ * It does so for every type of piece on the board, and adds every move it has found to \p moves.
  */
-std::vector<std::string> MoveGenerator::getPseudoLegalMoves(const BitbArray &bitboard, enumColor color) {
+void MoveGenerator::getPseudoLegalMoves(const BitbArray &bitboard, enumColor color, MoveList &moves) {
 	if (color == nColor) {
-		std::vector<std::string> white = getPseudoLegalMoves(bitboard, nWhite);
-		std::vector<std::string> black = getPseudoLegalMoves(bitboard, nBlack);
+		getPseudoLegalMoves(bitboard, nWhite, moves);
+		getPseudoLegalMoves(bitboard, nBlack, moves);
+		return;
+	}
 
-		// Concatenates both lists (inserts the black list on the end of white list)
-		white.insert(white.end(), black.begin(), black.end());
+	for (int k = nPawn; k <= nKing; k++) {
 
-		return white;
+		U64 pieces = bitboard[k];
+		pieces &= bitboard[color];
+
+		while (pieces) {
+			// Get index of least significant set bit and reset it
+			int i = pieces.popLsb();
+			addMoves(bitboard, k, i, getPieceMoves(bitboard, k, i, color), color, moves);
+		}
 	}
+}
 
-	uint64_t fromPos, toPos;
-	std::vector<std::string> moves;
-	std::vector<std::string> promotions;
 
-	BitbArray bitboardCopy = bitboard;
+/**
+ * @details Convenience overload that returns a new list instead of filling one given by the caller.
+ */
+MoveList MoveGenerator::getPseudoLegalMoves(const BitbArray &bitboard, enumColor color) {
+	MoveList moves;
+	getPseudoLegalMoves(bitboard, color, moves);
+	return moves;
+}
+
+
+/**
+ * @details Same traversal as MoveGenerator::getPseudoLegalMoves, but the moves of each piece are only counted. Every pawn move to the last rank counts as four moves, one for each promotion.
+ */
+int MoveGenerator::countPseudoLegalMoves(const BitbArray &bitboard, enumColor color) {
+	if (color == nColor)
+		return countPseudoLegalMoves(bitboard, nWhite) + countPseudoLegalMoves(bitboard, nBlack);
+
+	U64 lastRanks = U64(0xffL << 56) | U64(0xffL);
+	int count = 0;
 
 	for (int k = nPawn; k <= nKing; k++) {
+		U64 pieces = bitboard[k] & bitboard[color];
 
+		while (pieces) {
+			int i = pieces.popLsb();
 
-		U64 pieces = bitboard[k];
-		pieces &= bitboard[color];
+			U64 pieceMoves = getPieceMoves(bitboard, k, i, color);
 
-		U64 pieceMoves;
+			if (k == nPawn)
+				count += 3 * (pieceMoves & lastRanks).count();
 
-		uint64_t upieces = pieces.to_ullong();
+			count += pieceMoves.count();
+		}
+	}
 
-		int i, j;
+	return count;
+}
 
-		while (upieces) {
-			// Get index of least significant set bit
-			i = leastSignificantSetBit(upieces);
-			upieces ^= (1L << i); // Reset bit
 
-			bitboardCopy[k].reset();
-			bitboardCopy[k].set(i);
+/**
+ * @details Pawns and non-sliding pieces are found by looking up the attacks of the opposite color (or of the same piece) from \p idx, and sliders by looking up their attacks from \p idx with
+ * the given \p occupancy. Passing an occupancy different from the board allows testing squares as if pieces had moved.
+ */
+U64 MoveGenerator::attackersTo(const BitbArray &bitboard, int idx, U64 occupancy) {
+	return (pawnAttacks[nBlack][idx] & bitboard[nPawn] & bitboard[nWhite])
+		   | (pawnAttacks[nWhite][idx] & bitboard[nPawn] & bitboard[nBlack])
+		   | (knightAttacks[idx] & bitboard[nKnight])
+		   | (kingAttacks[idx] & bitboard[nKing])
+		   | (bishopAttacks(idx, occupancy) & (bitboard[nBishop] | bitboard[nQueen]))
+		   | (rookAttacks(idx, occupancy) & (bitboard[nRook] | bitboard[nQueen]));
+}
 
-			fromPos = 1L << i; // Original position
 
-			switch (k) {
-				case nPawn:
-					pieceMoves = getPawnMoves(bitboardCopy, color);
-					promotions = getPawnPromotions(pieceMoves, fromPos);
-					if (!promotions.empty()) {
-						moves.insert(moves.end(), promotions.begin(), promotions.end());
-					}
-					break;
+/**
+ * @details Same lookups as MoveGenerator::attackersTo, restricted to the pieces of \p color and stopping at the first attacker found.
+ */
+bool MoveGenerator::isSquareAttacked(const BitbArray &bitboard, int idx, enumColor color, U64 occupancy) {
+	U64 pieces = bitboard[color];
+
+	return (pawnAttacks[color == nWhite ? nBlack : nWhite][idx] & bitboard[nPawn] & pieces)
+		   || (knightAttacks[idx] & bitboard[nKnight] & pieces)
+		   || (kingAttacks[idx] & bitboard[nKing] & pieces)
+		   || (bishopAttacks(idx, occupancy) & (bitboard[nBishop] | bitboard[nQueen]) & pieces)
+		   || (rookAttacks(idx, occupancy) & (bitboard[nRook] | bitboard[nQueen]) & pieces);
+}
 
-				case nKnight:
-					pieceMoves = getKnightMoves(bitboardCopy, color);
-					break;
 
-				case nBishop:
-					pieceMoves = getBishopMoves(bitboardCopy, color);
-					break;
+/**
+ * @details Enemy pieces attacking the king of the side to move. Empty if there is no king on the board.
+ */
+U64 MoveGenerator::getCheckers(const Bitboard &board) {
+	const BitbArray &bitboard = board.getBitBoards();
+	enumColor us = board.getSideToMove();
+	U64 king = bitboard[nKing] & bitboard[us];
 
-				case nRook:
-					pieceMoves = getRookMoves(bitboardCopy, color);
-					break;
+	if (king.none())
+		return 0;
 
-				case nQueen:
-					pieceMoves = getQueenMoves(bitboardCopy, color);
-					break;
+	return attackersTo(bitboard, king.lsb(), bitboard[nColor]) & bitboard[us == nWhite ? nBlack : nWhite];
+}
 
-				case nKing:
-					pieceMoves = getKingMoves(bitboardCopy, color);
-					break;
-			}
 
-			uint64_t umoves = pieceMoves.to_ullong();
+/**
+ * @details Checkers, pinned pieces and the squares that resolve a check are computed once, and every move is restricted by them as it is generated, so no move has to be made on the board
+ * to be validated: <br>
+ * - in double check, only the king can move <br>
+ * - in single check, the other pieces can only capture the checker or block the line between it and the king <br>
+ * - pinned pieces can only move along the line through their king and the pinning slider <br>
+ * - the king cannot move to attacked squares. Attacks are computed without the king on the board, so it cannot step back along the line of a checking slider <br>
+ * - castling requires the squares between king and rook to be empty and the squares the king crosses to be safe. It is not allowed while in check <br>
+ * - en passant removes two pieces from the same rank at once, which may uncover an attack on the king that no pin mask shows, so it is tested by removing both pawns from the occupancy <br>
+ *
+ * The \p type of generation only restricts the destination squares, so generating gCaptures and then gQuiets yields the same moves as gAll.
+ */
+void MoveGenerator::getLegalMoves(const Bitboard &board, MoveList &moves, enumGenType type) {
+	const BitbArray &bitboard = board.getBitBoards();
+	enumColor us = board.getSideToMove();
+	enumColor them = (us == nWhite) ? nBlack : nWhite;
+
+	U64 king = bitboard[nKing] & bitboard[us];
+
+	// Without a king there are no checks nor pins to take into account
+	if (king.none()) {
+		MoveList pseudoLegal;
+		getPseudoLegalMoves(bitboard, us, pseudoLegal);
+		for (auto mv : pseudoLegal)
+			if (type == gAll || (type == gCaptures) == (mv.isCapture() || mv.isPromotion()))
+				moves.push_back(mv);
+		return;
+	}
 
-			// Loops through all possible moves that the piece of type k at the i position can make and adds it to the list of moves
-			while (umoves) {
-				j = leastSignificantSetBit(umoves);
-				umoves ^= (1L << j); // Reset bit
-				toPos = 1L << j; // Target position
+	int kingIdx = king.lsb();
+	U64 occupancy = bitboard[nColor];
+	U64 enemies = bitboard[them];
+	U64 checkers = getCheckers(board);
+	U64 lastRanks = U64(0xffL << 56) | U64(0xffL);
+
+	// Destination squares allowed by the type of generation. Pawn moves to the last rank are promotions, generated along with the captures
+	U64 typeMask = (type == gCaptures) ? enemies : (type == gQuiets) ? ~occupancy : ~bitboard[us];
+	U64 pawnTypeMask = (type == gCaptures) ? (enemies | lastRanks) : (type == gQuiets) ? (~occupancy & ~lastRanks) : ~bitboard[us];
+
+	// King moves. The king is removed from the occupancy so that sliders see through it
+	U64 kingMoves = kingAttacks[kingIdx] & typeMask;
+	while (kingMoves) {
+		int to = kingMoves.popLsb();
+		if (!isSquareAttacked(bitboard, to, them, occupancy ^ king))
+			moves.emplace_back(kingIdx, to, enemies.test(to) ? fCapture : fQuiet);
+	}
 
-				moves.push_back(moveName(fromPos, toPos));
-			}
+	// In double check only the king can move
+	if (checkers.count() > 1)
+		return;
+
+	// Squares where the other pieces can go: anywhere but on our own pieces, or on the checker and the squares between it and the king
+	U64 targets = checkers ? (checkers | betweenSquares[kingIdx][checkers.lsb()]) : ~bitboard[us];
+
+	// A piece is pinned if it is the only piece between the king and an enemy slider that would attack the king on an empty board
+	U64 pinned;
+	U64 snipers = ((bishopAttacks(kingIdx, 0) & (bitboard[nBishop] | bitboard[nQueen])) | (rookAttacks(kingIdx, 0) & (bitboard[nRook] | bitboard[nQueen]))) & enemies;
+	while (snipers) {
+		U64 blockers = betweenSquares[kingIdx][snipers.popLsb()] & occupancy;
+		if (blockers.count() == 1)
+			pinned |= blockers & bitboard[us];
+	}
+
+	for (int k = nPawn; k < nKing; k++) {
+		U64 pieces = bitboard[k] & bitboard[us];
+
+		while (pieces) {
+			int i = pieces.popLsb();
+
+			U64 pieceMoves = getPieceMoves(bitboard, k, i, us) & targets & (k == nPawn ? pawnTypeMask : typeMask);
+			if (pinned.test(i))
+				pieceMoves &= lineSquares[kingIdx][i];
+
+			addMoves(bitboard, k, i, pieceMoves, us, moves);
 		}
 	}
 
+	// En passant
+	int epSquare = board.getEpSquare();
+	if (epSquare != noSquare && type != gQuiets) {
+		int captured = epSquare + (us == nWhite ? sout : nort);
+		U64 pawns = pawnAttacks[them][epSquare] & bitboard[nPawn] & bitboard[us];
+
+		while (pawns) {
+			int from = pawns.popLsb();
+			U64 occupancyAfter = (occupancy ^ (U64(1) << from) ^ (U64(1) << captured)) | (U64(1) << epSquare);
+
+			if ((attackersTo(bitboard, kingIdx, occupancyAfter) & enemies & occupancyAfter).none())
+				moves.emplace_back(from, epSquare, fEnPassant);
+		}
+	}
+
+	// Castling
+	int rights = board.getCastlingRights() & (us == nWhite ? (cWhiteKing | cWhiteQueen) : (cBlackKing | cBlackQueen));
+	if (rights && checkers.none() && type != gCaptures) {
+		int rank = (us == nWhite) ? 0 : 56;
+		U64 rooks = bitboard[nRook] & bitboard[us];
+
+		if ((rights & (cWhiteKing | cBlackKing)) && kingIdx == e1 + rank && rooks.test(h1 + rank)
+			&& (occupancy & betweenSquares[e1 + rank][h1 + rank]).none()
+			&& !isSquareAttacked(bitboard, f1 + rank, them, occupancy) && !isSquareAttacked(bitboard, g1 + rank, them, occupancy))
+			moves.emplace_back(kingIdx, g1 + rank, fKingCastle);
+
+		if ((rights & (cWhiteQueen | cBlackQueen)) && kingIdx == e1 + rank && rooks.test(a1 + rank)
+			&& (occupancy & betweenSquares[e1 + rank][a1 + rank]).none()
+			&& !isSquareAttacked(bitboard, d1 + rank, them, occupancy) && !isSquareAttacked(bitboard, c1 + rank, them, occupancy))
+			moves.emplace_back(kingIdx, c1 + rank, fQueenCastle);
+	}
+}
+
+
+/**
+ * @details Convenience overload that returns a new list instead of filling one given by the caller.
+ */
+MoveList MoveGenerator::getLegalMoves(const Bitboard &board) {
+	MoveList moves;
+	getLegalMoves(board, moves);
 	return moves;
 }
+
+
+/**
+ * @details Ordinary moves are validated without generating the moves of the position: the piece on the origin square must belong to the side to move and reach the destination, the flags must
+ * match the board, and the king must not be attacked once the move is made. Castles, en passant captures and promotions are rare enough to be looked up in the list of legal moves instead.
+ */
+bool MoveGenerator::isLegal(const Bitboard &board, Move mv) {
+	if (!mv.isValid())
+		return false;
+
+	const BitbArray &bitboard = board.getBitBoards();
+	enumColor us = board.getSideToMove();
+	enumColor them = (us == nWhite) ? nBlack : nWhite;
+	int from = mv.getFrom(), to = mv.getTo();
+	enumPiece piece = board.pieceOn(from);
+
+	if (!bitboard[us].test(from))
+		return false;
+
+	if (mv.isPromotion() || mv.getFlags() == fEnPassant || mv.getFlags() == fKingCastle || mv.getFlags() == fQueenCastle)
+		return getLegalMoves(board).contains(mv);
+
+	if (!getPieceMoves(bitboard, piece, from, us).test(to) || (piece == nPawn && (to < 8 || to >= 56)))
+		return false;
+
+	if (bitboard[them].test(to) != (mv.getFlags() == fCapture))
+		return false;
+
+	if ((piece == nPawn && (to - from == 16 || from - to == 16)) != (mv.getFlags() == fDoublePush))
+		return false;
+
+	U64 king = bitboard[nKing] & bitboard[us];
+	if (king.none())
+		return true;
+
+	// The king cannot move to an attacked square. Other pieces cannot leave the king attacked, unless the move captures the attacker
+	U64 occupancy = (bitboard[nColor] ^ (U64(1) << from)) | (U64(1) << to);
+	if (piece == nKing)
+		return !isSquareAttacked(bitboard, to, them, occupancy);
+
+	return (attackersTo(bitboard, king.lsb(), occupancy) & bitboard[them] & ~(U64(1) << to)).none();
+}
+
+
+/**
+ * @details Swap algorithm: the pieces of both sides capture on the destination square in turns, least valuable attacker first, and each side may stop capturing when it is ahead. Only the
+ * balance against \p threshold is tracked, so the loop ends as soon as the outcome is known. Removing a capturing piece from the occupancy reveals the sliders behind it (x-rays), which are
+ * then added to the attackers. Pins are not taken into account. <br>
+ * Castles, en passant captures and promotions are assumed to be even exchanges.
+ * @ref https://www.chessprogramming.org/Static_Exchange_Evaluation
+ */
+bool MoveGenerator::seeGE(const Bitboard &board, Move mv, int threshold) {
+	if (mv.isPromotion() || mv.getFlags() == fEnPassant || mv.getFlags() == fKingCastle || mv.getFlags() == fQueenCastle)
+		return 0 >= threshold;
+
+	const BitbArray &bitboard = board.getBitBoards();
+	int from = mv.getFrom(), to = mv.getTo();
+
+	// Balance after capturing the piece on the destination square
+	int swap = pieceValue[board.pieceOn(to)] - threshold;
+	if (swap < 0)
+		return false;
+
+	// Balance if the moved piece is captured back. If still ahead, the exchange cannot fail
+	swap = pieceValue[board.pieceOn(from)] - swap;
+	if (swap <= 0)
+		return true;
+
+	enumColor stm = bitboard[nWhite].test(from) ? nWhite : nBlack;
+	U64 occupancy = bitboard[nColor] ^ (U64(1) << from) ^ (U64(1) << to);
+	U64 attackers = attackersTo(bitboard, to, occupancy);
+	U64 diagonal = bitboard[nBishop] | bitboard[nQueen];
+	U64 orthogonal = bitboard[nRook] | bitboard[nQueen];
+	int result = 1;
+
+	while (true) {
+		stm = (stm == nWhite) ? nBlack : nWhite;
+		attackers &= occupancy;
+
+		U64 stmAttackers = attackers & bitboard[stm];
+		if (stmAttackers.none())
+			break;
+
+		result ^= 1;
+
+		// The least valuable attacker captures next. Sliders behind it are revealed
+		U64 piece;
+		if ((piece = stmAttackers & bitboard[nPawn])) {
+			if ((swap = pieceValue[nPawn] - swap) < result)
+				break;
+			occupancy ^= U64(1) << piece.lsb();
+			attackers |= bishopAttacks(to, occupancy) & diagonal;
+		} else if ((piece = stmAttackers & bitboard[nKnight])) {
+			if ((swap = pieceValue[nKnight] - swap) < result)
+				break;
+			occupancy ^= U64(1) << piece.lsb();
+		} else if ((piece = stmAttackers & bitboard[nBishop])) {
+			if ((swap = pieceValue[nBishop] - swap) < result)
+				break;
+			occupancy ^= U64(1) << piece.lsb();
+			attackers |= bishopAttacks(to, occupancy) & diagonal;
+		} else if ((piece = stmAttackers & bitboard[nRook])) {
+			if ((swap = pieceValue[nRook] - swap) < result)
+				break;
+			occupancy ^= U64(1) << piece.lsb();
+			attackers |= rookAttacks(to, occupancy) & orthogonal;
+		} else if ((piece = stmAttackers & bitboard[nQueen])) {
+			if ((swap = pieceValue[nQueen] - swap) < result)
+				break;
+			occupancy ^= U64(1) << piece.lsb();
+			attackers |= (bishopAttacks(to, occupancy) & diagonal) | (rookAttacks(to, occupancy) & orthogonal);
+		} else {
+			// The king can only capture if the square is no longer defended
+			return (attackers & ~bitboard[stm]) ? result ^ 1 : result;
+		}
+	}
+
+	return bool(result);
+}
+
+
+/**
+ * @details Swap list: the pieces of both sides capture on the destination square in turns, least valuable attacker first, and the speculative gain of every capture is saved. The list is
+ * then folded back from the last capture, since each side may stop capturing when continuing would lose material. X-rays are revealed as in MoveGenerator::seeGE, and the king only
+ * captures if the square is no longer defended. The list lives on the stack, as there cannot be more captures than pieces. <br>
+ * Castles, en passant captures and promotions are assumed to be even exchanges, so that see(board, mv) >= threshold matches seeGE(board, mv, threshold).
+ * @ref https://www.chessprogramming.org/SEE_-_The_Swap_Algorithm
+ */
+int MoveGenerator::see(const Bitboard &board, Move mv) {
+	if (mv.isPromotion() || mv.getFlags() == fEnPassant || mv.getFlags() == fKingCastle || mv.getFlags() == fQueenCastle)
+		return 0;
+
+	const BitbArray &bitboard = board.getBitBoards();
+	int from = mv.getFrom(), to = mv.getTo();
+
+	enumColor stm = bitboard[nWhite].test(from) ? nWhite : nBlack;
+	enumPiece attacker = board.pieceOn(from);
+	U64 diagonal = bitboard[nBishop] | bitboard[nQueen];
+	U64 orthogonal = bitboard[nRook] | bitboard[nQueen];
+
+	// The moved piece can be on any line through the destination square (e.g. a pawn push), so the attackers are computed once it has left its square
+	U64 occupancy = bitboard[nColor] ^ (U64(1) << from);
+	U64 attackers = attackersTo(bitboard, to, occupancy);
+
+	int gain[32];
+	int depth = 1;
+	gain[0] = pieceValue[board.pieceOn(to)];
+	gain[1] = pieceValue[attacker] - gain[0];
+
+	while (true) {
+		attackers &= occupancy;
+
+		stm = (stm == nWhite) ? nBlack : nWhite;
+		U64 stmAttackers = attackers & bitboard[stm];
+		if (stmAttackers.none())
+			break;
+
+		for (int piece = nPawn; piece <= nKing; piece++) {
+			U64 candidates = stmAttackers & bitboard[piece];
+			if (candidates) {
+				attacker = enumPiece(piece);
+				from = candidates.lsb();
+				break;
+			}
+		}
+
+		if (attacker == nKing && (attackers & ~bitboard[stm]))
+			break;
+
+		// Gain if the piece that has just captured is captured back
+		depth++;
+		gain[depth] = pieceValue[attacker] - gain[depth - 1];
+
+		// Captures happen along the line to the destination square, so removing the capturing piece reveals the sliders of that kind behind it
+		occupancy ^= U64(1) << from;
+		if (attacker == nPawn || attacker == nBishop || attacker == nQueen)
+			attackers |= bishopAttacks(to, occupancy) & diagonal;
+		if (attacker == nRook || attacker == nQueen)
+			attackers |= rookAttacks(to, occupancy) & orthogonal;
+	}
+
+	// The last entry is the gain of a capture nobody can make
+	while (--depth)
+		gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+
+	return gain[0];
+}
@@ -2,6 +2,7 @@
 #define CHESSQDL_MOVEGEN_HPP
 
 #include "bitboard.hpp"
+#include "move.hpp"
 
 #include <vector>
 
@@ -146,6 +147,29 @@ namespace chessqdl {
 		 */
 		static U64 noWeOccl(U64 generator, U64 propagator);
 
+
+		/**
+		 * @brief Generates the pseudo-legal moves of a single piece
+		 * @param bitboard  reference to bitboards representing the current board status
+		 * @param k  index of the bitboard of the piece type (e.g nPawn)
+		 * @param idx  index of the square where the piece is
+		 * @param color  color of the piece
+		 * @return Bitboard with the pseudo-legal moves of the piece
+		 */
+		static U64 getPieceMoves(const BitbArray &bitboard, int k, int idx, enumColor color);
+
+
+		/**
+		 * @brief Adds the moves of a single piece to a list of moves, setting their flags
+		 * @param bitboard  reference to bitboards representing the current board status
+		 * @param k  index of the bitboard of the piece type (e.g nPawn)
+		 * @param from  index of the square where the piece is
+		 * @param pieceMoves  bitboard with the destination squares of the piece
+		 * @param color  color of the piece
+		 * @param moves  list where the moves will be added
+		 */
+		static void addMoves(const BitbArray &bitboard, int k, int from, U64 pieceMoves, enumColor color, MoveList &moves);
+
 	public:
 
 		MoveGenerator() = default;
@@ -186,7 +210,7 @@ namespace chessqdl {
 
 
 		/**
-		 * @brief Get pseudo-legal moves for a given color set of bishops
+		 * @brief Get pseudo-legal moves for a given color set of bishops. Set-wise Kogge-Stone implementation, also used as reference for the magic bitboard lookups
 		 * @param bitboard  reference to bitboards representing the current board status
 		 * @param color  color of desired piece
 		 * @return Bitboard with pseudo-legal moves for bishops of a given color.
@@ -195,7 +219,7 @@ namespace chessqdl {
 
 
 		/**
-		 * @brief Get pseudo-legal moves for a given color set of rooks
+		 * @brief Get pseudo-legal moves for a given color set of rooks. Set-wise Kogge-Stone implementation, also used as reference for the magic bitboard lookups
 		 * @param bitboard  reference to bitboards representing the current board status
 		 * @param color  color of desired piece
 		 * @return Bitboard with pseudo-legal moves for rooks of a given color.
@@ -212,21 +236,162 @@ namespace chessqdl {
 		static U64 getQueenMoves(const BitbArray &bitboard, enumColor color);
 
 
+		/**
+		 * @brief Looks up the squares attacked by a bishop, with the backend selected by MoveGenerator::setSliderBackend
+		 * @param idx  index of the square where the bishop is
+		 * @param occupancy  bitboard with all pieces on the board
+		 * @return Bitboard with the attacked squares, including the first blocker on each diagonal (of any color)
+		 */
+		static U64 bishopAttacks(int idx, U64 occupancy);
+
+
+		/**
+		 * @brief Looks up the squares attacked by a rook, with the backend selected by MoveGenerator::setSliderBackend
+		 * @param idx  index of the square where the rook is
+		 * @param occupancy  bitboard with all pieces on the board
+		 * @return Bitboard with the attacked squares, including the first blocker on each line (of any color)
+		 */
+		static U64 rookAttacks(int idx, U64 occupancy);
+
+
+		/**
+		 * @brief Looks up the squares attacked by a queen, with the backend selected by MoveGenerator::setSliderBackend
+		 * @param idx  index of the square where the queen is
+		 * @param occupancy  bitboard with all pieces on the board
+		 * @return Bitboard with the attacked squares, including the first blocker on each line (of any color)
+		 */
+		static U64 queenAttacks(int idx, U64 occupancy);
+
+
+		/**
+		 * @brief Returns true if the CPU supports the PEXT instruction (BMI2)
+		 */
+		static bool isPextSupported();
+
+
+		/**
+		 * @brief Selects how slider attacks are looked up. backendAuto prefers PEXT on CPUs where it is fast and falls back to magic bitboards otherwise
+		 * @param backend  the desired backend
+		 * @return false if PEXT was requested but is not supported by the CPU. Magic bitboards are used in that case
+		 */
+		static bool setSliderBackend(enumSliderBackend backend);
+
+
+		/**
+		 * @brief Returns the backend in use for slider attack lookups (backendMagic or backendPext)
+		 */
+		static enumSliderBackend getSliderBackend();
+
+
 		/**
 		 * @brief Checks for pawns that are about to promote and generates moves for all possible promotions
-		 * @param bitboard  bitboards representing current state of the game
-		 * @param pawnMoves  all possible pawn moves
-		 * @return Vector with all possible promotions. (e.g e7e8n e7e8b e7e8r e7e8q)
+		 * @param pawnMoves  all possible pawn moves. Promoting moves are removed from it
+		 * @param fromPos  unsigned number with only one bit set representing the position of the pawn
+		 * @param moves  list where the promotions will be added. (e.g e7e8n e7e8b e7e8r e7e8q)
+		 */
+		static void getPawnPromotions(U64 &pawnMoves, uint64_t fromPos, MoveList &moves);
+
+
+		/**
+		 * @brief Get all possible pseudo-legal moves for a given bitboard
+		 * @param bitboard  reference to bitboards representing the current board status
+		 * @param color  color of desired piece
+		 * @param moves  list where the moves will be added
 		 */
-		static std::vector<std::string> getPawnPromotions(U64 &pawnMoves, uint64_t fromPos);
+		static void getPseudoLegalMoves(const BitbArray &bitboard, enumColor color, MoveList &moves);
+
 
 		/**
 		 * @brief Get all possible pseudo-legal moves for a given bitboard
 		 * @param bitboard  reference to bitboards representing the current board status
 		 * @param color  color of desired piece
-		 * @return  a list of all possible moves (e.g "e2e4", "b1c3", etc)
+		 * @return  a list of all possible moves
+		 */
+		static MoveList getPseudoLegalMoves(const BitbArray &bitboard, enumColor color);
+
+
+		/**
+		 * @brief Counts the pseudo-legal moves for a given bitboard without generating them
+		 * @param bitboard  reference to bitboards representing the current board status
+		 * @param color  color of desired piece
+		 * @return  the number of moves that MoveGenerator::getPseudoLegalMoves would generate
+		 */
+		static int countPseudoLegalMoves(const BitbArray &bitboard, enumColor color);
+
+
+
+		/**
+		 * @brief Returns the pieces of both colors that attack a square
+		 * @param bitboard  reference to bitboards representing the current board status
+		 * @param idx  index of the square
+		 * @param occupancy  pieces blocking sliders. Usually bitboard[nColor]
+		 * @return Bitboard with the attackers of the square
+		 */
+		static U64 attackersTo(const BitbArray &bitboard, int idx, U64 occupancy);
+
+
+		/**
+		 * @brief Tests if any piece of \p color attacks a square
+		 * @param bitboard  reference to bitboards representing the current board status
+		 * @param idx  index of the square
+		 * @param color  color of the attacking pieces
+		 * @param occupancy  pieces blocking sliders. Usually bitboard[nColor]
+		 * @return true if the square is attacked, false otherwise
+		 */
+		static bool isSquareAttacked(const BitbArray &bitboard, int idx, enumColor color, U64 occupancy);
+
+
+		/**
+		 * @brief Returns the pieces giving check to the side to move
+		 * @param board  the current board
+		 * @return Bitboard with the checking pieces. Empty if the side to move is not in check
+		 */
+		static U64 getCheckers(const Bitboard &board);
+
+
+		/**
+		 * @brief Get the legal moves of the side to move, including castles and en passant captures
+		 * @param board  the current board
+		 * @param moves  list where the moves will be added
+		 * @param type  kind of moves to generate (captures, quiets or all)
+		 */
+		static void getLegalMoves(const Bitboard &board, MoveList &moves, enumGenType type = gAll);
+
+
+		/**
+		 * @brief Get all legal moves of the side to move, including castles and en passant captures
+		 * @param board  the current board
+		 * @return  a list of all legal moves
+		 */
+		static MoveList getLegalMoves(const Bitboard &board);
+
+
+		/**
+		 * @brief Tests if a move is legal in the given position. Used for moves that were not generated for the position, such as killer moves
+		 * @param board  the current board
+		 * @param mv  the move to be tested
+		 * @return true if \p mv is one of the moves generated by MoveGenerator::getLegalMoves, false otherwise
+		 */
+		static bool isLegal(const Bitboard &board, Move mv);
+
+
+		/**
+		 * @brief Static exchange evaluation. Tests if the sequence of captures on the destination square of a move, starting with the move, wins at least \p threshold material
+		 * @param board  the current board
+		 * @param mv  the move that starts the exchange
+		 * @param threshold  minimum gain, in pawns (see pieceValue)
+		 * @return true if the side making the move ends up at least \p threshold ahead, assuming both sides play the best sequence of captures
+		 */
+		static bool seeGE(const Bitboard &board, Move mv, int threshold = 0);
+
+
+		/**
+		 * @brief Static exchange evaluation. Computes the material won by the sequence of captures on the destination square of a move, starting with the move
+		 * @param board  the current board
+		 * @param mv  the move that starts the exchange
+		 * @return the material won by the side making the move, in pawns (see pieceValue), assuming both sides play the best sequence of captures. Negative if material is lost
 		 */
-		static std::vector<std::string> getPseudoLegalMoves(const BitbArray &bitboard, enumColor color);
+		static int see(const Bitboard &board, Move mv);
 
 	};
 
@@ -0,0 +1,250 @@
+#include "movepick.hpp"
+#include "movegen.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+using namespace chessqdl;
+
+
+MoveHistory::MoveHistory() {
+	clear();
+}
+
+
+/**
+ * @details Zeroes the butterfly table and forgets every countermove.
+ */
+void MoveHistory::clear() {
+	std::fill(&butterfly[0][0][0], &butterfly[0][0][0] + 2 * 64 * 64, 0);
+	std::fill(&counterMoves[0][0], &counterMoves[0][0] + 64 * 64, Move());
+}
+
+
+/**
+ * @details Countermoves are kept: they are replaced as soon as another move refutes the same move.
+ */
+void MoveHistory::age() {
+	for (auto &byColor : butterfly)
+		for (auto &byFrom : byColor)
+			for (int &score : byFrom)
+				score /= 2;
+}
+
+
+/**
+ * @details The closer the score is to the bound, the smaller the effective bonus, so frequent moves saturate instead of overflowing and a penalty takes effect right away on them.
+ */
+void MoveHistory::addBonus(int &score, int bonus) {
+	score += bonus - score * std::abs(bonus) / maxScore;
+}
+
+
+int MoveHistory::getScore(enumColor color, Move mv) const {
+	return butterfly[color][mv.getFrom()][mv.getTo()];
+}
+
+
+Move MoveHistory::getCounterMove(Move previous) const {
+	return counterMoves[previous.getFrom()][previous.getTo()];
+}
+
+
+/**
+ * @details The bonus grows with the square of the depth, since cutoffs close to the root save more work. It is capped so that a single deep cutoff does not override the rest of the table.
+ */
+void MoveHistory::update(enumColor color, Move best, const MoveList &tried, int depth, Move previous) {
+	int bonus = std::min(depth * depth, 400);
+
+	addBonus(butterfly[color][best.getFrom()][best.getTo()], bonus);
+
+	for (Move mv : tried)
+		if (mv != best)
+			addBonus(butterfly[color][mv.getFrom()][mv.getTo()], -bonus);
+
+	if (previous.isValid())
+		counterMoves[previous.getFrom()][previous.getTo()] = best;
+}
+
+
+/**
+ * @details In check, all evasions are generated at once since they are few. The killers and the countermove are only handed out if they are legal quiet moves in this position.
+ */
+MovePicker::MovePicker(const Bitboard &board, Move ttMove, Move killer1, Move killer2, const MoveHistory *history) : board(board), ttMove(ttMove), history(history) {
+	stage = MoveGenerator::getCheckers(board) ? sGenerateEvasions : sGenerateCaptures;
+
+	if (ttMove.isValid() && MoveGenerator::isLegal(board, ttMove))
+		stage = sTTMove;
+	else
+		this->ttMove = Move();
+
+	refutations[0] = killer1;
+	refutations[1] = killer2;
+
+	Move lastMove = board.getLastMove();
+	if (history && lastMove.isValid()) {
+		Move counterMove = history->getCounterMove(lastMove);
+		if (counterMove != killer1 && counterMove != killer2)
+			refutations[2] = counterMove;
+	}
+}
+
+
+/**
+ * @details Starts directly at the generation of captures (or evasions), since the quiescence search has neither a transposition table move nor killers.
+ */
+MovePicker::MovePicker(const Bitboard &board) : board(board), capturesOnly(true) {
+	stage = MoveGenerator::getCheckers(board) ? sGenerateEvasions : sGenerateCaptures;
+}
+
+
+/**
+ * @details The victim is the piece on the destination square, or a pawn for en passant captures.
+ */
+void MovePicker::scoreCaptures() {
+	for (int i = 0; i < moves.size(); i++) {
+		Move mv = moves[i];
+		enumPiece victim = board.pieceOn(mv.getTo());
+
+		if (mv.getFlags() == fEnPassant)
+			victim = nPawn;
+
+		scores[i] = (victim == nNoPiece) ? 0 : 8 * (victim - nPawn + 1);
+		scores[i] -= board.pieceOn(mv.getFrom()) - nPawn;
+
+		if (mv.isPromotion())
+			scores[i] += 8 * (mv.getPromotion() - nPawn);
+	}
+}
+
+
+/**
+ * @details Only the moves from MovePicker::current on are quiet moves. Without a history all scores are equal, and MovePicker::pickBest keeps the generation order.
+ */
+void MovePicker::scoreQuiets() {
+	for (int i = current; i < moves.size(); i++)
+		scores[i] = history ? history->getScore(board.getSideToMove(), moves[i]) : 0;
+}
+
+
+/**
+ * @details Selection sort one step at a time, so that no time is spent sorting the moves after a cutoff.
+ */
+Move MovePicker::pickBest(int end) {
+	int best = current;
+
+	for (int i = current + 1; i < end; i++)
+		if (scores[i] > scores[best])
+			best = i;
+
+	std::swap(moves[current], moves[best]);
+	std::swap(scores[current], scores[best]);
+
+	return moves[current++];
+}
+
+
+/**
+ * @details Compares against the transposition table move, the killers and the countermove, which are handed out before the stage they belong to.
+ */
+bool MovePicker::alreadyTried(Move mv) const {
+	return mv == ttMove || mv == refutations[0] || mv == refutations[1] || mv == refutations[2];
+}
+
+
+/**
+ * @details Goes through the stages in order, generating the moves of a stage only once the previous stages are exhausted. The killers and the countermove are handed out only if they are
+ * legal quiet moves, and are then skipped when the quiet moves are generated. <br>
+ * Captures that lose material according to the static exchange evaluation are unlikely to cause a cutoff, so they are put aside and handed out after the quiet moves. The quiescence
+ * search prunes them itself, so captures are not split in that mode.
+ */
+Move MovePicker::nextMove() {
+	while (true) {
+		switch (stage) {
+			case sTTMove:
+				stage = MoveGenerator::getCheckers(board) ? sGenerateEvasions : sGenerateCaptures;
+				return ttMove;
+
+			case sGenerateCaptures:
+				moves.clear();
+				current = 0;
+				endBadCaptures = 0;
+				MoveGenerator::getLegalMoves(board, moves, gCaptures);
+				scoreCaptures();
+				stage = sCaptures;
+				break;
+
+			case sCaptures:
+				while (current < moves.size()) {
+					Move mv = pickBest(moves.size());
+					if (mv == ttMove)
+						continue;
+
+					// The slots before MovePicker::current were already handed out, so they can be reused
+					if (!capturesOnly && !MoveGenerator::seeGE(board, mv)) {
+						scores[endBadCaptures] = MoveGenerator::see(board, mv);
+						moves[endBadCaptures++] = mv;
+						continue;
+					}
+
+					return mv;
+				}
+				stage = capturesOnly ? sDone : sKillers;
+				break;
+
+			case sKillers:
+				while (refutationIdx < 3) {
+					Move mv = refutations[refutationIdx++];
+					if (mv.isValid() && mv != ttMove && !mv.isCapture() && !mv.isPromotion() && MoveGenerator::isLegal(board, mv))
+						return mv;
+					// Refutations that cannot be played here must not be skipped among the quiet moves
+					refutations[refutationIdx - 1] = Move();
+				}
+				stage = sGenerateQuiets;
+				break;
+
+			case sGenerateQuiets:
+				current = moves.size();
+				MoveGenerator::getLegalMoves(board, moves, gQuiets);
+				scoreQuiets();
+				stage = sQuiets;
+				break;
+
+			case sQuiets:
+				while (current < moves.size()) {
+					Move mv = pickBest(moves.size());
+					if (!alreadyTried(mv))
+						return mv;
+				}
+				current = 0;
+				stage = sBadCaptures;
+				break;
+
+			case sBadCaptures:
+				if (current < endBadCaptures)
+					return pickBest(endBadCaptures);
+				stage = sDone;
+				break;
+
+			case sGenerateEvasions:
+				moves.clear();
+				current = 0;
+				MoveGenerator::getLegalMoves(board, moves, gAll);
+				scoreCaptures();
+				stage = sEvasions;
+				break;
+
+			case sEvasions:
+				while (current < moves.size()) {
+					Move mv = pickBest(moves.size());
+					if (mv != ttMove)
+						return mv;
+				}
+				stage = sDone;
+				break;
+
+			default:
+				return Move();
+		}
+	}
+}
@@ -0,0 +1,211 @@
+#ifndef CHESSQDL_MOVEPICK_HPP
+#define CHESSQDL_MOVEPICK_HPP
+
+#include "bitboard.hpp"
+#include "move.hpp"
+
+namespace chessqdl {
+
+	/**
+	 * @brief Stages of the move picker, in the order they are gone through
+	 */
+	enum enumPickerStage {
+		sTTMove,				// move from the transposition table, tried before generating anything
+		sGenerateCaptures,		// generates and scores captures and promotions
+		sCaptures,				// captures that do not lose material, best MVV-LVA score first
+		sKillers,				// quiet moves that caused a cutoff in sibling nodes, then the countermove
+		sGenerateQuiets,		// generates and scores the remaining moves
+		sQuiets,				// quiet moves, best history score first
+		sBadCaptures,			// captures that lose material, the smallest loss first
+		sGenerateEvasions,		// generates all moves at once when in check
+		sEvasions,				// check evasions, captures first
+		sDone					// no moves left
+	};
+
+
+	/**
+	 * @brief Statistics on the quiet moves that caused cutoffs, used to order the quiet moves. Kept by the search across its iterations and the moves of a game
+	 * @ref https://www.chessprogramming.org/History_Heuristic <br>
+	 * https://www.chessprogramming.org/Countermove_Heuristic
+	 */
+	class MoveHistory {
+
+	public:
+
+		/**
+		 * @brief Bound of the absolute value of the history scores
+		 */
+		static constexpr int maxScore = 16384;
+
+	private:
+
+		/**
+		 * @brief Butterfly history, indexed by color, origin and destination square of the move
+		 */
+		int butterfly[2][64][64];
+
+		/**
+		 * @brief Quiet move that last refuted each move, indexed by origin and destination square of the move refuted
+		 */
+		Move counterMoves[64][64];
+
+		/**
+		 * @brief Adds \p bonus to a history score, scaled so that the score never leaves [-maxScore, maxScore]
+		 */
+		static void addBonus(int &score, int bonus);
+
+	public:
+
+		/**
+		 * @brief Default constructor. Starts with empty tables
+		 */
+		MoveHistory();
+
+		/**
+		 * @brief Resets all scores and countermoves
+		 */
+		void clear();
+
+		/**
+		 * @brief Halves all scores, so that statistics from older searches weigh less than the new ones
+		 */
+		void age();
+
+		/**
+		 * @brief Returns the history score of the quiet move \p mv made by \p color
+		 */
+		int getScore(enumColor color, Move mv) const;
+
+		/**
+		 * @brief Returns the quiet move that last refuted \p previous, or the null move
+		 */
+		Move getCounterMove(Move previous) const;
+
+		/**
+		 * @brief Rewards a quiet move that caused a cutoff and penalizes the quiet moves searched before it
+		 * @param color  color of the side that made the moves
+		 * @param best  move that caused the cutoff
+		 * @param tried  quiet moves searched before \p best
+		 * @param depth  remaining depth of the node
+		 * @param previous  move that led to the node (null move at the root)
+		 */
+		void update(enumColor color, Move best, const MoveList &tried, int depth, Move previous);
+
+	};
+
+
+	/**
+	 * @brief Hands out the legal moves of a position one at a time, in the order they are most likely to cause a cutoff. Moves are generated in stages, so when a move causes a cutoff
+	 * the moves of the following stages are never generated.
+	 */
+	class MovePicker {
+
+	private:
+
+		/**
+		 * @brief Board where the moves are made. Must not change while the picker is in use
+		 */
+		const Bitboard &board;
+
+		/**
+		 * @brief Move suggested by the transposition table (null if none)
+		 */
+		Move ttMove;
+
+		/**
+		 * @brief Killer moves of the current ply followed by the countermove of the last move (null if none)
+		 */
+		Move refutations[3];
+
+		/**
+		 * @brief History used to score the quiet moves (null if none)
+		 */
+		const MoveHistory *history = nullptr;
+
+		/**
+		 * @brief Current stage
+		 */
+		int stage;
+
+		/**
+		 * @brief When set, only captures and promotions are handed out (unless in check). Used by the quiescence search
+		 */
+		bool capturesOnly = false;
+
+		/**
+		 * @brief Index of the next move of MovePicker::refutations to be tried
+		 */
+		int refutationIdx = 0;
+
+		/**
+		 * @brief Moves generated for the current stage
+		 */
+		MoveList moves;
+
+		/**
+		 * @brief Ordering score of each move in MovePicker::moves
+		 */
+		int scores[MoveList::capacity];
+
+		/**
+		 * @brief Index of the next move to be handed out from MovePicker::moves
+		 */
+		int current = 0;
+
+		/**
+		 * @brief Captures that lose material are put aside at the start of MovePicker::moves, up to this index. The quiet moves are generated after the captures
+		 */
+		int endBadCaptures = 0;
+
+		/**
+		 * @brief Scores captures by the value of the captured piece first and the value of the capturing piece second (Most Valuable Victim - Least Valuable Attacker).
+		 * Promotions are scored as captures of the promoted piece
+		 */
+		void scoreCaptures();
+
+		/**
+		 * @brief Scores quiet moves by their history score
+		 */
+		void scoreQuiets();
+
+		/**
+		 * @brief Finds the move with the highest score among the ones not handed out yet and moves it to the current position
+		 * @param end  index after the last move to be considered
+		 * @return the move with the highest score
+		 */
+		Move pickBest(int end);
+
+		/**
+		 * @brief Returns true if \p mv was already handed out by the transposition table or killer stages
+		 */
+		bool alreadyTried(Move mv) const;
+
+	public:
+
+		/**
+		 * @brief Creates a picker for the moves of the side to move
+		 * @param board  the current board
+		 * @param ttMove  move from the transposition table. It is checked for legality
+		 * @param killer1  first killer move of the current ply
+		 * @param killer2  second killer move of the current ply
+		 * @param history  history used to order the quiet moves and find the countermove. Quiet moves are handed out in generation order if null
+		 */
+		MovePicker(const Bitboard &board, Move ttMove, Move killer1 = Move(), Move killer2 = Move(), const MoveHistory *history = nullptr);
+
+		/**
+		 * @brief Creates a picker for the quiescence search, which hands out captures and promotions only. When in check all evasions are handed out, so that mates are detected
+		 * @param board  the current board
+		 */
+		explicit MovePicker(const Bitboard &board);
+
+		/**
+		 * @brief Returns the next move to be searched
+		 * @return the next move, or the null move when there are no moves left
+		 */
+		Move nextMove();
+
+	};
+
+}
+
+#endif //CHESSQDL_MOVEPICK_HPP
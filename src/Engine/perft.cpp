@@ -0,0 +1,159 @@
+#include "perft.hpp"
+#include "movegen.hpp"
+#include "threadpool.hpp"
+
+using namespace chessqdl;
+
+
+/**
+ * @details Allocates the largest power of two of entries that fits in \p megabytes, and at least one.
+ */
+PerftTable::PerftTable(size_t megabytes) {
+	uint64_t count = 1;
+	while (count * 2 * sizeof(Entry) <= megabytes * 1024 * 1024)
+		count *= 2;
+
+	entries.reset(new Entry[count]);
+	mask = count - 1;
+}
+
+
+/**
+ * @details The depth is mixed into the index with a multiplicative hash, so the counts of one position at several depths do not compete for the same entry.
+ */
+PerftTable::Entry &PerftTable::entryOf(uint64_t key, int depth) const {
+	return entries[(key ^ (uint64_t(depth) * 0x9e3779b97f4a7c15)) & mask];
+}
+
+
+/**
+ * @details The entry is accepted if XORing both words gives back \p key and the depth stored is \p depth. Empty entries have depth 0, which is never probed.
+ */
+bool PerftTable::probe(uint64_t key, int depth, uint64_t &nodes) const {
+	const Entry &entry = entryOf(key, depth);
+	uint64_t data = entry.data.load(std::memory_order_relaxed);
+	uint64_t check = entry.key.load(std::memory_order_relaxed);
+
+	if ((check ^ data) != key || int(data >> 56) != depth)
+		return false;
+
+	nodes = data & 0x00ffffffffffffff;
+	return true;
+}
+
+
+/**
+ * @details Data is written before the checked key, so readers see either the old or the new entry, or an entry that fails the check.
+ */
+void PerftTable::store(uint64_t key, int depth, uint64_t nodes) {
+	Entry &entry = entryOf(key, depth);
+	uint64_t data = uint64_t(depth) << 56 | (nodes & 0x00ffffffffffffff);
+	entry.data.store(data, std::memory_order_relaxed);
+	entry.key.store(key ^ data, std::memory_order_relaxed);
+}
+
+
+/**
+ * @details Bulk counting: the moves of the last ply are only generated and counted, never made, since the generator only gives legal moves. This skips the most expensive part of the
+ * tree, the leaves, which are most of its nodes. Subtrees of depth 1 are not hashed, since counting them is cheaper than a probe.
+ */
+uint64_t Perft::count(Bitboard &board, int depth, PerftTable *table) {
+	if (depth < 0)
+		return 0;
+	if (depth == 0)
+		return 1;
+
+	uint64_t nodes = 0;
+	if (depth > 1 && table && table->probe(board.getKey(), depth, nodes))
+		return nodes;
+
+	MoveList moves;
+	MoveGenerator::getLegalMoves(board, moves);
+
+	if (depth == 1)
+		return moves.size();
+
+	for (Move mv : moves) {
+		board.doMove(mv);
+		nodes += count(board, depth - 1, table);
+		board.undoMove();
+	}
+
+	if (table)
+		table->store(board.getKey(), depth, nodes);
+
+	return nodes;
+}
+
+
+uint64_t Perft::perft(Bitboard &board, int depth) {
+	return count(board, depth, nullptr);
+}
+
+
+std::vector<std::pair<Move, uint64_t>> Perft::divide(Bitboard &board, int depth) {
+	std::vector<std::pair<Move, uint64_t>> counts;
+
+	MoveList moves;
+	MoveGenerator::getLegalMoves(board, moves);
+
+	for (Move mv : moves) {
+		board.doMove(mv);
+		counts.emplace_back(mv, count(board, depth - 1, nullptr));
+		board.undoMove();
+	}
+
+	return counts;
+}
+
+
+/**
+ * @details The tasks are the subtrees two plies below the root, so that there are many more tasks than threads and a few large subtrees do not leave the other threads idle at the end.
+ * Every task counts on its own copy of the board and writes its count to its own slot, which are added up per root move once all of them are finished.
+ */
+std::vector<std::pair<Move, uint64_t>> Perft::divide(const Bitboard &board, int depth, int threads, PerftTable *table) {
+	std::vector<std::pair<Move, uint64_t>> counts;
+
+	MoveList moves;
+	MoveGenerator::getLegalMoves(board, moves);
+
+	if (depth <= 2) {
+		Bitboard position = board;
+		for (Move mv : moves) {
+			position.doMove(mv);
+			counts.emplace_back(mv, count(position, depth - 1, table));
+			position.undoMove();
+		}
+		return counts;
+	}
+
+	// One task for every reply to every root move
+	std::vector<std::pair<int, Move>> tasks;
+	Bitboard position = board;
+	for (int i = 0; i < moves.size(); i++) {
+		counts.emplace_back(moves[i], 0);
+
+		MoveList replies;
+		position.doMove(moves[i]);
+		MoveGenerator::getLegalMoves(position, replies);
+		position.undoMove();
+
+		for (Move reply : replies)
+			tasks.emplace_back(i, reply);
+	}
+
+	std::vector<uint64_t> taskCounts(tasks.size());
+	ThreadPool pool(threads);
+
+	pool.run(tasks.size(), [&](int task) {
+		Bitboard subtree = board;
+		subtree.doMove(moves[tasks[task].first]);
+		subtree.doMove(tasks[task].second);
+		taskCounts[task] = count(subtree, depth - 2, table);
+	});
+
+	for (size_t task = 0; task < tasks.size(); task++)
+		counts[tasks[task].first].second += taskCounts[task];
+
+	return counts;
+}
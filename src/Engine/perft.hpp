@@ -0,0 +1,122 @@
+#ifndef CHESSQDL_PERFT_HPP
+#define CHESSQDL_PERFT_HPP
+
+#include "bitboard.hpp"
+#include "move.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace chessqdl {
+
+	/**
+	 * @brief Fixed size hash table with the perft counts of the subtrees already counted, indexed by Zobrist key and depth. Transpositions are very common in deep perft trees, and every
+	 * one of them found in the table saves counting its whole subtree again. It is shared by every thread without locks, in the same way as the TranspositionTable: each entry holds the
+	 * packed data and the key XORed with the data, and is only accepted when both words agree.
+	 * @ref https://www.chessprogramming.org/Perft#Hashing
+	 */
+	class PerftTable {
+
+	private:
+
+		/**
+		 * @brief Entry of the table. The data packs the depth in the 8 most significant bits and the count in the other 56
+		 */
+		struct Entry {
+			std::atomic<uint64_t> key{0};		// key XOR data
+			std::atomic<uint64_t> data{0};		// packed depth and count
+		};
+
+		/**
+		 * @brief Entries of the table. The amount of entries is a power of two
+		 */
+		std::unique_ptr<Entry[]> entries;
+
+		/**
+		 * @brief Amount of entries minus one, used to index entries by key
+		 */
+		uint64_t mask = 0;
+
+		/**
+		 * @brief Returns the entry where the count of the position \p key at depth \p depth is stored. The same position has a different entry at every depth
+		 */
+		Entry &entryOf(uint64_t key, int depth) const;
+
+	public:
+
+		/**
+		 * @brief Creates a table of \p megabytes megabytes. The amount of entries is rounded down to a power of two
+		 */
+		explicit PerftTable(size_t megabytes);
+
+		/**
+		 * @brief Looks up the count of a subtree
+		 * @param key  Zobrist key of the position
+		 * @param depth  depth of the subtree
+		 * @param nodes  filled with the count if it is found
+		 * @return true if the count was found, false otherwise
+		 */
+		bool probe(uint64_t key, int depth, uint64_t &nodes) const;
+
+		/**
+		 * @brief Saves the count of a subtree, replacing whatever the entry held
+		 * @param key  Zobrist key of the position
+		 * @param depth  depth of the subtree
+		 * @param nodes  number of leaf nodes of the subtree
+		 */
+		void store(uint64_t key, int depth, uint64_t nodes);
+
+	};
+
+
+	/**
+	 * @brief Performance test of the move generator: counts the leaf nodes of the tree of legal moves up to a fixed depth. The counts of well known positions are published, so they
+	 * verify the move generator together with Bitboard::doMove and Bitboard::undoMove, and the time taken measures the speed of both.
+	 * @ref https://www.chessprogramming.org/Perft <br>
+	 * https://www.chessprogramming.org/Perft_Results
+	 */
+	class Perft {
+
+	private:
+
+		/**
+		 * @brief Counts the leaf nodes of the tree of legal moves of \p board up to \p depth, saving and reusing the counts of subtrees in \p table if it is not null
+		 */
+		static uint64_t count(Bitboard &board, int depth, PerftTable *table);
+
+	public:
+
+		/**
+		 * @brief Counts the leaf nodes of the tree of legal moves of \p board up to \p depth. The board is left as it was
+		 * @param board  position to start from
+		 * @param depth  depth of the tree. Depth 0 counts the position itself, and negative depths count nothing
+		 * @return number of leaf nodes
+		 */
+		static uint64_t perft(Bitboard &board, int depth);
+
+		/**
+		 * @brief Counts the leaf nodes below each legal move of \p board. Comparing the counts with those of another generator shows which move is wrong
+		 * @param board  position to start from
+		 * @param depth  depth of the tree, including the root moves. Must be at least 1
+		 * @return every legal move with its number of leaf nodes, in the order of the move generator
+		 */
+		static std::vector<std::pair<Move, uint64_t>> divide(Bitboard &board, int depth);
+
+		/**
+		 * @brief Same as Perft::divide, with the subtrees counted by \p threads threads and the counts of transpositions shared through \p table
+		 * @param board  position to start from
+		 * @param depth  depth of the tree, including the root moves. Must be at least 1
+		 * @param threads  number of threads, including the calling one
+		 * @param table  table shared by the threads, or null to count every subtree in full
+		 * @return every legal move with its number of leaf nodes, in the order of the move generator
+		 */
+		static std::vector<std::pair<Move, uint64_t>> divide(const Bitboard &board, int depth, int threads, PerftTable *table);
+
+	};
+
+}
+
+#endif //CHESSQDL_PERFT_HPP
@@ -0,0 +1,123 @@
+#include "threadpool.hpp"
+
+#include <algorithm>
+
+using namespace chessqdl;
+
+
+/**
+ * @details Creates one queue per thread, and threads - 1 workers that wait for the first batch.
+ */
+ThreadPool::ThreadPool(int threads) {
+	threads = std::max(1, threads);
+
+	for (int i = 0; i < threads; i++)
+		queues.push_back(std::make_unique<WorkQueue>());
+
+	for (int i = 1; i < threads; i++)
+		workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	wakeUp.notify_all();
+
+	for (auto &worker : workers)
+		worker.join();
+}
+
+
+/**
+ * @details A thread takes its own tasks from the back of its queue and steals from the front of the others, starting with the next queue, so that a thief and the owner seldom compete
+ * for the same task.
+ */
+bool ThreadPool::popTask(int self, int &task) {
+	int n = queues.size();
+
+	for (int i = 0; i < n; i++) {
+		WorkQueue &queue = *queues[(self + i) % n];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+
+		if (!queue.tasks.empty()) {
+			if (i == 0) {
+				task = queue.tasks.back();
+				queue.tasks.pop_back();
+			} else {
+				task = queue.tasks.front();
+				queue.tasks.pop_front();
+			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/**
+ * @details The thread that finishes the last task of the batch wakes up the thread waiting in ThreadPool::run.
+ */
+void ThreadPool::work(int self) {
+	int task;
+
+	while (popTask(self, task)) {
+		job(task);
+
+		if (pending.fetch_sub(1) == 1) {
+			std::lock_guard<std::mutex> lock(mutex);
+			done.notify_all();
+		}
+	}
+}
+
+
+void ThreadPool::workerLoop(int self) {
+	int seen = 0;
+
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wakeUp.wait(lock, [&] { return quit || generation != seen; });
+
+			if (quit)
+				return;
+
+			seen = generation;
+		}
+
+		work(self);
+	}
+}
+
+
+/**
+ * @details The tasks are dealt to the queues in turns, so that each thread starts with a share of the batch, and the threads that run out of tasks steal the rest.
+ */
+void ThreadPool::run(int tasks, std::function<void(int)> newJob) {
+	if (tasks <= 0)
+		return;
+
+	job = std::move(newJob);
+	pending = tasks;
+
+	for (int i = 0; i < tasks; i++) {
+		WorkQueue &queue = *queues[i % queues.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(i);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		generation++;
+	}
+	wakeUp.notify_all();
+
+	work(0);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [&] { return pending == 0; });
+}
@@ -0,0 +1,125 @@
+#ifndef CHESSQDL_THREADPOOL_HPP
+#define CHESSQDL_THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace chessqdl {
+
+	/**
+	 * @brief Fixed set of threads that run batches of independent tasks. Every thread has its own queue of tasks, and a thread whose queue is empty steals tasks from the queues of the
+	 * others, so that threads given cheap tasks help the ones given expensive tasks. The thread that starts a batch works on it as well.
+	 * @ref https://en.wikipedia.org/wiki/Work_stealing
+	 */
+	class ThreadPool {
+
+	private:
+
+		/**
+		 * @brief Tasks waiting to be run by one thread
+		 */
+		struct WorkQueue {
+			std::mutex mutex;
+			std::deque<int> tasks;
+		};
+
+		/**
+		 * @brief Threads of the pool. The thread that starts a batch is not one of them, and works on queue 0
+		 */
+		std::vector<std::thread> workers;
+
+		/**
+		 * @brief Queue of each thread. Queue i + 1 belongs to ThreadPool::workers[i]
+		 */
+		std::vector<std::unique_ptr<WorkQueue>> queues;
+
+		/**
+		 * @brief Function run for every task of the current batch. Only read after a task is taken from a queue, which orders the read after the write of ThreadPool::run
+		 */
+		std::function<void(int)> job;
+
+		/**
+		 * @brief Tasks of the current batch that have not finished yet
+		 */
+		std::atomic<int> pending{0};
+
+		/**
+		 * @brief Guards ThreadPool::generation and ThreadPool::quit
+		 */
+		std::mutex mutex;
+
+		/**
+		 * @brief Wakes up the workers when a batch starts or the pool is destroyed
+		 */
+		std::condition_variable wakeUp;
+
+		/**
+		 * @brief Wakes up the thread that started the batch when its last task finishes
+		 */
+		std::condition_variable done;
+
+		/**
+		 * @brief Number of batches started. Workers compare it with the last batch they worked on
+		 */
+		int generation = 0;
+
+		/**
+		 * @brief Set when the pool is destroyed
+		 */
+		bool quit = false;
+
+		/**
+		 * @brief Takes the next task of the queue \p self, or steals the oldest task of another queue
+		 * @param self  index of the queue of the calling thread
+		 * @param task  the task taken
+		 * @return false if all queues are empty
+		 */
+		bool popTask(int self, int &task);
+
+		/**
+		 * @brief Runs tasks until all queues are empty
+		 * @param self  index of the queue of the calling thread
+		 */
+		void work(int self);
+
+		/**
+		 * @brief Main loop of the workers: waits for a batch and works on it
+		 * @param self  index of the queue of the worker
+		 */
+		void workerLoop(int self);
+
+	public:
+
+		/**
+		 * @brief Starts the workers
+		 * @param threads  number of threads that work on each batch, including the one that starts it
+		 */
+		explicit ThreadPool(int threads);
+
+		/**
+		 * @brief Stops and joins the workers. Must not be called while a batch is running
+		 */
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool &) = delete;
+
+		ThreadPool &operator=(const ThreadPool &) = delete;
+
+		/**
+		 * @brief Runs \p newJob for every task from 0 to \p tasks - 1 and returns when all of them are finished. The order and the thread each task runs on are not specified
+		 * @param tasks  number of tasks
+		 * @param newJob  function called with the index of each task
+		 */
+		void run(int tasks, std::function<void(int)> newJob);
+
+	};
+
+}
+
+#endif //CHESSQDL_THREADPOOL_HPP
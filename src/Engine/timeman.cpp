@@ -0,0 +1,83 @@
+#include "timeman.hpp"
+
+#include <algorithm>
+
+using namespace chessqdl;
+
+
+/**
+ * @details With a fixed time per move both limits are that time. Otherwise the time left is split between the moves to go (30 if the amount is unknown), and most of the increment is
+ * added, since it is given back after the move. The hard limit allows spending up to 4 times the soft limit, but never more than a third of the clock, unless it is the last move before
+ * the time control. Both limits keep the move overhead in reserve.
+ */
+void TimeManager::start(const SearchLimits &limits) {
+	startTime = std::chrono::steady_clock::now();
+	instability = 0;
+	timed = limits.isTimed();
+
+	if (limits.moveTime > 0) {
+		softLimit = hardLimit = std::max(1, limits.moveTime - moveOverhead);
+	} else if (limits.time > 0) {
+		int available = std::max(1, limits.time - moveOverhead);
+		int movesToGo = limits.movesToGo > 0 ? std::min(limits.movesToGo, 50) : 30;
+
+		softLimit = std::min(available, limits.time / movesToGo + limits.increment * 3 / 4);
+		hardLimit = std::min(movesToGo == 1 ? available : std::max(softLimit, available / 3), softLimit * 4);
+		softLimit = std::max(1, softLimit);
+		hardLimit = std::max(softLimit, hardLimit);
+	} else
+		softLimit = hardLimit = 0;
+}
+
+
+/**
+ * @details Reads the monotonic clock.
+ */
+int TimeManager::elapsed() const {
+	return int(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count());
+}
+
+
+/**
+ * @details Never true for searches limited by depth only.
+ */
+bool TimeManager::hardLimitReached() const {
+	return timed && elapsed() >= hardLimit;
+}
+
+
+/**
+ * @details The soft limit is scaled up by half of the instability, but not beyond the hard limit. An iteration usually takes longer than all the previous ones together, so it is not
+ * started once half of the scaled soft limit has passed, as it would most likely be stopped by the hard limit before completing.
+ */
+bool TimeManager::softLimitReached() const {
+	if (!timed)
+		return false;
+
+	double scaled = std::min(double(hardLimit), softLimit * (1.0 + 0.5 * instability));
+	return elapsed() >= scaled / 2;
+}
+
+
+/**
+ * @details Every change of best move adds one to the instability, and it halves with every iteration, so only recent changes count.
+ */
+void TimeManager::iterationCompleted(bool bestMoveChanged) {
+	instability = instability / 2 + (bestMoveChanged ? 1 : 0);
+}
+
+
+/**
+ * @details Returns the limit computed by TimeManager::start.
+ */
+int TimeManager::getSoftLimit() const {
+	return softLimit;
+}
+
+
+/**
+ * @details Returns the limit computed by TimeManager::start.
+ */
+int TimeManager::getHardLimit() const {
+	return hardLimit;
+}
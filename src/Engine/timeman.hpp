@@ -0,0 +1,106 @@
+#ifndef CHESSQDL_TIMEMAN_HPP
+#define CHESSQDL_TIMEMAN_HPP
+
+#include <chrono>
+
+namespace chessqdl {
+
+	/**
+	 * @brief Clock of the engine. All times are in milliseconds, and zero means not set
+	 */
+	struct SearchLimits {
+		int time = 0;			// time left on the engine's clock
+		int increment = 0;		// time added to the clock after each move
+		int movesToGo = 0;		// moves until the next time control (0 for sudden death)
+		int moveTime = 0;		// fixed time for every move. Takes precedence over the clock
+
+		/**
+		 * @brief Returns true if the search is limited by time
+		 */
+		bool isTimed() const { return time > 0 || moveTime > 0; }
+	};
+
+
+	/**
+	 * @brief Decides how long the engine thinks on a move. Two deadlines are computed when the search starts: <br>
+	 * the soft limit is the time the move should take. No new iteration is started after it, unless the best move keeps changing between iterations, which extends it. <br>
+	 * the hard limit is the time the move may take. The search is stopped when it is reached, even in the middle of an iteration. <br>
+	 */
+	class TimeManager {
+
+	private:
+
+		/**
+		 * @brief Time reserved for the communication and the moves made outside the search, which is never used for thinking
+		 */
+		static constexpr int moveOverhead = 20;
+
+		/**
+		 * @brief Time the search started
+		 */
+		std::chrono::steady_clock::time_point startTime;
+
+		/**
+		 * @brief Time the move should take
+		 */
+		int softLimit = 0;
+
+		/**
+		 * @brief Time the move may take
+		 */
+		int hardLimit = 0;
+
+		/**
+		 * @brief Decaying count of recent best move changes. The soft limit is extended by it
+		 */
+		double instability = 0;
+
+		/**
+		 * @brief False when the search is only limited by depth
+		 */
+		bool timed = false;
+
+	public:
+
+		/**
+		 * @brief Starts the clock of a new search and computes its deadlines
+		 * @param limits  clock of the engine
+		 */
+		void start(const SearchLimits &limits);
+
+		/**
+		 * @brief Returns the time since the search started in milliseconds
+		 */
+		int elapsed() const;
+
+		/**
+		 * @brief Returns true if the search must be stopped right away. Cheap enough to be polled from within the search
+		 */
+		bool hardLimitReached() const;
+
+		/**
+		 * @brief Returns true if there is no time left to start another iteration
+		 */
+		bool softLimitReached() const;
+
+		/**
+		 * @brief Must be called after every completed iteration, so that thinking is extended while the best move is unstable
+		 * @param bestMoveChanged  true if the iteration found a different best move than the previous one
+		 */
+		void iterationCompleted(bool bestMoveChanged);
+
+		/**
+		 * @brief Returns the soft limit in milliseconds (0 if the search is not timed)
+		 */
+		int getSoftLimit() const;
+
+		/**
+		 * @brief Returns the hard limit in milliseconds (0 if the search is not timed)
+		 */
+		int getHardLimit() const;
+
+	};
+
+}
+
+#endif //CHESSQDL_TIMEMAN_HPP
@@ -0,0 +1,199 @@
+#include "tt.hpp"
+#include "const.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace chessqdl;
+
+
+/**
+ * @details Allocates the buckets with TranspositionTable::resize.
+ */
+TranspositionTable::TranspositionTable(size_t megabytes, bool onlyCurrentSearch) : currentOnly(onlyCurrentSearch) {
+	resize(megabytes);
+}
+
+
+/**
+ * @details Resizes with TranspositionTable::resizeBytes.
+ */
+void TranspositionTable::resize(size_t megabytes) {
+	resizeBytes(megabytes * 1024 * 1024);
+}
+
+
+/**
+ * @details Rounding the amount of buckets to a power of two allows indexing with a mask instead of a division. At least one bucket is always allocated.
+ */
+void TranspositionTable::resizeBytes(size_t bytes) {
+	uint64_t count = 1;
+	while (count * 2 * sizeof(Bucket) <= bytes)
+		count *= 2;
+
+	buckets.reset(new Bucket[count]);
+	mask = count - 1;
+	clear();
+}
+
+
+/**
+ * @details Resets both words of every entry. Empty entries have data 0.
+ */
+void TranspositionTable::clear() {
+	for (uint64_t i = 0; i <= mask; i++) {
+		for (int j = 0; j < bucketSize; j++) {
+			buckets[i].keys[j].store(0, std::memory_order_relaxed);
+			buckets[i].data[j].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	generation = 0;
+}
+
+
+/**
+ * @details Generations take 6 bits in the packed entries, so they wrap around every 64 searches. A table that only keeps entries of the current search is really cleared when they
+ * wrap around, since entries written 64 searches ago would be taken as current otherwise.
+ */
+void TranspositionTable::newSearch() {
+	generation = (generation + 1) & 63;
+
+	if (currentOnly && generation == 0)
+		clear();
+}
+
+
+/**
+ * @details Empty entries have data 0.
+ */
+bool TranspositionTable::isUsable(uint64_t data) const {
+	return data != 0 && (!currentOnly || generationOf(data) == generation);
+}
+
+
+/**
+ * @details The score is stored as a 16 bits signed integer, which holds every score the evaluation and the mate scores produce.
+ */
+uint64_t TranspositionTable::pack(Move move, int score, int depth, enumBound bound, int gen) {
+	assert(score >= INT16_MIN && score <= INT16_MAX);
+	return uint64_t(move.getRaw()) | uint64_t(uint16_t(int16_t(score))) << 16 | uint64_t(uint8_t(depth)) << 32 | uint64_t(bound) << 40 | uint64_t(gen) << 42;
+}
+
+
+/**
+ * @details Extracts bits 42-47.
+ */
+int TranspositionTable::generationOf(uint64_t data) {
+	return (data >> 42) & 63;
+}
+
+
+/**
+ * @details Extracts bits 32-39.
+ */
+int TranspositionTable::depthOf(uint64_t data) {
+	return (data >> 32) & 0xff;
+}
+
+
+/**
+ * @details Both words of each entry of the bucket are read, and the entry is accepted if XORing them gives back \p key. Empty entries have bound bNone and are never accepted, and
+ * neither are entries from older searches in a table that only keeps the current one.
+ */
+bool TranspositionTable::probe(uint64_t key, TTEntry &entry) const {
+	const Bucket &bucket = buckets[key & mask];
+
+	for (int i = 0; i < bucketSize; i++) {
+		uint64_t data = bucket.data[i].load(std::memory_order_relaxed);
+		uint64_t check = bucket.keys[i].load(std::memory_order_relaxed);
+
+		if ((check ^ data) == key && ((data >> 40) & 3) != bNone && isUsable(data)) {
+			entry.move = Move(int(data >> 6) & 0x3f, int(data) & 0x3f, int(data >> 12) & 0xf);
+			entry.score = int16_t(uint16_t(data >> 16));
+			entry.depth = depthOf(data);
+			entry.bound = enumBound((data >> 40) & 3);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/**
+ * @details The replacement value of an entry is its depth minus twice the amount of searches since it was written, and empty entries (including the ones that are not usable)
+ * are replaced first. Data is written before the
+ * checked key, so readers see either the old or the new entry, or an entry that fails the check.
+ */
+void TranspositionTable::store(uint64_t key, int depth, enumBound bound, int score, Move move) {
+	Bucket &bucket = buckets[key & mask];
+	int gen = generation;
+
+	int replace = 0;
+	int lowestValue = intMax;
+
+	for (int i = 0; i < bucketSize; i++) {
+		uint64_t data = bucket.data[i].load(std::memory_order_relaxed);
+		uint64_t check = bucket.keys[i].load(std::memory_order_relaxed);
+
+		if ((check ^ data) == key && isUsable(data)) {
+			if (!move.isValid())
+				move = Move(int(data >> 6) & 0x3f, int(data) & 0x3f, int(data >> 12) & 0xf);
+			replace = i;
+			break;
+		}
+
+		int value = !isUsable(data) ? intMin : depthOf(data) - 2 * ((gen - generationOf(data)) & 63);
+		if (value < lowestValue) {
+			lowestValue = value;
+			replace = i;
+		}
+	}
+
+	uint64_t data = pack(move, score, depth, bound, gen);
+	bucket.data[replace].store(data, std::memory_order_relaxed);
+	bucket.keys[replace].store(key ^ data, std::memory_order_relaxed);
+}
+
+
+/**
+ * @details Counts the entries written by the current search in the first 250 buckets (1000 entries), or in all buckets if the table is smaller.
+ */
+int TranspositionTable::hashfull() const {
+	uint64_t sampled = std::min<uint64_t>(250, mask + 1);
+	int count = 0;
+
+	for (uint64_t i = 0; i < sampled; i++)
+		for (int j = 0; j < bucketSize; j++) {
+			uint64_t data = buckets[i].data[j].load(std::memory_order_relaxed);
+			if (data != 0 && generationOf(data) == generation)
+				count++;
+		}
+
+	return int(count * 1000 / (sampled * bucketSize));
+}
+
+
+/**
+ * @details Mate scores are stored as the distance from the current position, since the same position may be reached at different distances from the root.
+ */
+int TranspositionTable::scoreToTT(int score, int ply) {
+	if (score >= scoreMate - maxSearchPly)
+		return score + ply;
+	if (score <= -scoreMate + maxSearchPly)
+		return score - ply;
+	return score;
+}
+
+
+/**
+ * @details Converts the distance to mate back to distance from the root.
+ */
+int TranspositionTable::scoreFromTT(int score, int ply) {
+	if (score >= scoreMate - maxSearchPly)
+		return score - ply;
+	if (score <= -scoreMate + maxSearchPly)
+		return score + ply;
+	return score;
+}
@@ -0,0 +1,175 @@
+#ifndef CHESSQDL_TT_HPP
+#define CHESSQDL_TT_HPP
+
+#include "move.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace chessqdl {
+
+	/**
+	 * @brief How the score of a transposition table entry relates to the exact score of the position
+	 */
+	enum enumBound {
+		bNone,			// empty entry
+		bUpper,			// the exact score is at most the stored score (no move reached alpha)
+		bLower,			// the exact score is at least the stored score (a move caused a beta cutoff)
+		bExact			// the stored score is exact
+	};
+
+
+	/**
+	 * @brief Unpacked content of a transposition table entry
+	 */
+	struct TTEntry {
+		Move move;			// best move found (null if none)
+		int score;			// score from the point of view of the side to move, with mate scores relative to the position
+		int depth;			// remaining depth of the search that produced the entry
+		enumBound bound;	// type of the score
+	};
+
+
+	/**
+	 * @brief Fixed size hash table with the results of previous searches, indexed by Zobrist key. It is shared by every copy of the engine and by every thread searching, without locks: <br>
+	 * each entry is made of two 64 bits atomics, the packed data and the key XORed with the data. An entry is only accepted when XORing both words gives back the key of the position, so an
+	 * entry written by two threads at once (one word from each) is detected and discarded instead of being read as corrupted data.
+	 * @ref https://www.chessprogramming.org/Shared_Hash_Table#Lockless
+	 */
+	class TranspositionTable {
+
+	private:
+
+		/**
+		 * @brief Amount of entries in each bucket
+		 */
+		static constexpr int bucketSize = 4;
+
+		/**
+		 * @brief Group of entries that fits in a single cache line. A key can only be stored in the bucket its lowest bits index
+		 */
+		struct alignas(64) Bucket {
+			std::atomic<uint64_t> keys[bucketSize];		// key XOR data of each entry
+			std::atomic<uint64_t> data[bucketSize];		// packed entry (see TranspositionTable::pack)
+		};
+
+		/**
+		 * @brief Buckets of the table. The amount of buckets is a power of two
+		 */
+		std::unique_ptr<Bucket[]> buckets;
+
+		/**
+		 * @brief Amount of buckets minus one, used to index buckets by key
+		 */
+		uint64_t mask = 0;
+
+		/**
+		 * @brief Incremented on every new search, so that entries from older searches are replaced first
+		 */
+		std::atomic<int> generation{0};
+
+		/**
+		 * @brief If set, entries from older searches are treated as empty, so TranspositionTable::newSearch empties the table without touching it
+		 */
+		bool currentOnly = false;
+
+		/**
+		 * @brief Returns true if an entry with packed data \p data is not empty and may be used by the current search
+		 */
+		bool isUsable(uint64_t data) const;
+
+		/**
+		 * @brief Packs an entry in 64 bits: move (16 bits), score (16 bits), depth (8 bits), bound (2 bits) and generation (6 bits)
+		 */
+		static uint64_t pack(Move move, int score, int depth, enumBound bound, int gen);
+
+		/**
+		 * @brief Returns the generation of a packed entry
+		 */
+		static int generationOf(uint64_t data);
+
+		/**
+		 * @brief Returns the depth of a packed entry
+		 */
+		static int depthOf(uint64_t data);
+
+	public:
+
+		/**
+		 * @brief Size of the table in megabytes when not specified
+		 */
+		static constexpr int defaultSize = 16;
+
+		/**
+		 * @brief Creates a table of \p megabytes megabytes
+		 * @param megabytes  size of the table
+		 * @param onlyCurrentSearch  treat entries from older searches as empty. Every search then starts with an empty table, as if TranspositionTable::clear had been called
+		 */
+		explicit TranspositionTable(size_t megabytes = defaultSize, bool onlyCurrentSearch = false);
+
+		/**
+		 * @brief Reallocates the table with the given size, discarding all entries. The amount of buckets is rounded down to a power of two. Must not be called while searching
+		 * @param megabytes  new size of the table
+		 */
+		void resize(size_t megabytes);
+
+		/**
+		 * @brief Same as TranspositionTable::resize, with the size in bytes. Used for tables smaller than a megabyte
+		 * @param bytes  new size of the table
+		 */
+		void resizeBytes(size_t bytes);
+
+		/**
+		 * @brief Empties every entry
+		 */
+		void clear();
+
+		/**
+		 * @brief Must be called at the start of every search, so that older entries can be told apart. Empties the table if it only keeps entries of the current search
+		 */
+		void newSearch();
+
+		/**
+		 * @brief Looks up a position
+		 * @param key  Zobrist key of the position
+		 * @param entry  filled with the content of the entry if it is found
+		 * @return true if an entry for the position was found, false otherwise
+		 */
+		bool probe(uint64_t key, TTEntry &entry) const;
+
+		/**
+		 * @brief Saves the result of a search. The entry of the same position is overwritten if there is one. Otherwise the entry of the bucket with the lowest depth is replaced,
+		 * with entries from older searches counting as shallower
+		 * @param key  Zobrist key of the position
+		 * @param depth  remaining depth of the search
+		 * @param bound  type of the score
+		 * @param score  score from the point of view of the side to move, converted with TranspositionTable::scoreToTT
+		 * @param move  best move found. If null, the move of an entry of the same position is kept
+		 */
+		void store(uint64_t key, int depth, enumBound bound, int score, Move move);
+
+		/**
+		 * @brief Returns an estimate of how full the table is, in permille, by sampling the first buckets
+		 */
+		int hashfull() const;
+
+		/**
+		 * @brief Converts a mate score from distance to the root to distance to the current position before it is stored
+		 * @param score  the score to be stored
+		 * @param ply  distance from the root of the search
+		 */
+		static int scoreToTT(int score, int ply);
+
+		/**
+		 * @brief Converts a mate score read from the table back to distance to the root. Inverse of TranspositionTable::scoreToTT
+		 * @param score  the score read from the table
+		 * @param ply  distance from the root of the search
+		 */
+		static int scoreFromTT(int score, int ply);
+
+	};
+
+}
+
+#endif //CHESSQDL_TT_HPP
@@ -1,7 +1,6 @@
 #include "utils.hpp"
 #include "movegen.hpp"
 
-#include <cmath>
 #include <iostream>
 
 using namespace chessqdl;
@@ -10,12 +9,7 @@ using namespace chessqdl;
  * @details The method only takes into account the LSB of \p position. Thus, if there is more than 1 bit set (or even 0) the return value will not be accurate.
  */
 std::string chessqdl::posToStr(uint64_t pos) {
-
-	// Least significant set bit
-	pos &= -pos;
-
-	// log2(pos) is the index of the bit that is set
-	return mapPositions[log2(pos)];
+	return mapPositions[leastSignificantSetBit(pos)];
 }
 
 
@@ -57,12 +51,11 @@ int chessqdl::evaluateBoard(const BitbArray &board, enumColor color) {
 	int p = (board[nPawn] & board[color]).count();
 	int pPrime = board[nPawn].count() - p;
 
-	MoveGenerator gen;
 	enumColor enemyColor = color == nWhite ? nBlack : nWhite;
 
 	// Move count
-	int m = gen.getPseudoLegalMoves(board, color).size();
-	int mPrime = gen.getPseudoLegalMoves(board, enemyColor).size();
+	int m = MoveGenerator::countPseudoLegalMoves(board, color);
+	int mPrime = MoveGenerator::countPseudoLegalMoves(board, enemyColor);
 
 	int score = 200 * (k - kPrime) + 9 * (q - qPrime) + 5 * (r - rPrime) + 3 * (n - nPrime + b - bPrime) + (p - pPrime);
 	score += 0.1 * (m - mPrime);
@@ -85,12 +78,10 @@ void chessqdl::readInteger(int &n) {
 
 
 /**
- * @details Performs some bitset operations to encounter the least significant bit that is set. Log2 just finds out its index
+ * @details Counts the trailing zeros of \p value, which is the index of the least significant bit that is set. \p value must not be zero
  */
 int chessqdl::leastSignificantSetBit(uint64_t value) {
-	uint64_t lsb = value & -value;
-
-	return log2(lsb);
+	return U64(value).lsb();
 }
 
 /**
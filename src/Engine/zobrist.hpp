@@ -0,0 +1,67 @@
+#ifndef CHESSQDL_ZOBRIST_HPP
+#define CHESSQDL_ZOBRIST_HPP
+
+#include "const.hpp"
+
+#include <cstdint>
+
+namespace chessqdl {
+
+	/**
+	 * @brief Random keys used to hash positions. The key of a position is the XOR of the keys of every piece on its square, plus the keys of the side to move, the castling rights and the
+	 * file of the en passant square. Making a move only XORs in and out the keys that change.
+	 * @ref https://www.chessprogramming.org/Zobrist_Hashing
+	 */
+	struct ZobristKeys {
+		uint64_t pieces[2][6][64]{};	// indexed by color, piece type (from nPawn) and square
+		uint64_t blackToMove = 0;		// included when black is to move
+		uint64_t castling[16]{};		// indexed by the combination of enumCastling flags
+		uint64_t epFile[8]{};			// indexed by the file of the en passant square
+	};
+
+
+	/**
+	 * @brief Pseudo random number generator (xorshift64*) used to fill the keys at compile time. The seed is fixed, so keys are the same on every run and platform
+	 * @ref https://en.wikipedia.org/wiki/Xorshift#xorshift*
+	 */
+	constexpr uint64_t nextRandom(uint64_t &state) {
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		return state * 2685821657736338717ULL;
+	}
+
+
+	/**
+	 * @brief Fills every Zobrist key with a pseudo random number
+	 */
+	constexpr ZobristKeys makeZobristKeys() {
+		ZobristKeys keys;
+		uint64_t state = 1070372;
+
+		for (auto &color : keys.pieces)
+			for (auto &piece : color)
+				for (auto &square : piece)
+					square = nextRandom(state);
+
+		keys.blackToMove = nextRandom(state);
+
+		// Positions without castling rights have no castling key
+		for (int i = 1; i < 16; i++)
+			keys.castling[i] = nextRandom(state);
+
+		for (auto &file : keys.epFile)
+			file = nextRandom(state);
+
+		return keys;
+	}
+
+
+	/**
+	 * @brief Zobrist keys of the engine. Computed at compile time
+	 */
+	inline constexpr ZobristKeys zobrist = makeZobristKeys();
+
+}
+
+#endif //CHESSQDL_ZOBRIST_HPP
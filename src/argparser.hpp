@@ -4,11 +4,16 @@
 #include <iostream>
 #include <cxxopts.hpp>
 #include "Engine/utils.hpp"
+#include "Engine/movegen.hpp"
+#include "Engine/tt.hpp"
+#include "Engine/timeman.hpp"
+#include "Engine/engine.hpp"
 
 using namespace chessqdl;
 
 
-void argumentParser(int argc, char **argv, int &level, enumColor &enginePieces, bool &verbose, std::string &fen, bool &pvp) {
+void argumentParser(int argc, char **argv, int &level, enumColor &enginePieces, bool &verbose, std::string &fen, bool &pvp, int &hashSize, SearchLimits &limits,
+					SearchFeatures &features, int &threads, enumSearchMode &searchMode, int &perftDepth, bool &divide) {
 	cxxopts::Options options("ChessQDL", "Simple chess engine with a terminal interface");
 
 	options.add_options()
@@ -17,6 +22,22 @@ void argumentParser(int argc, char **argv, int &level, enumColor &enginePieces,
 			("v,verbose", "Be verbose")
 			("l,level", "Level of the engine. The higher the value, the higher the difficulty. Accepted values range from 1 to 10", cxxopts::value(level))
 			("f,fen", "FEN string that represents the initial state of the desired board", cxxopts::value(fen))
+			("slider-attacks", "Lookup used for bishop, rook and queen attacks: auto, magic or pext", cxxopts::value<std::string>()->default_value("auto"))
+			("time", "Time on the engine's clock in milliseconds. Without --level, the search depth is only limited by time", cxxopts::value(limits.time))
+			("inc", "Time added to the engine's clock after each move, in milliseconds", cxxopts::value(limits.increment))
+			("movestogo", "Moves until the next time control. The clock must last the whole game if not set", cxxopts::value(limits.movesToGo))
+			("movetime", "Fixed thinking time per move in milliseconds. Without --level, the search depth is only limited by time", cxxopts::value(limits.moveTime))
+			("hash", "Size of the transposition table in megabytes", cxxopts::value(hashSize)->default_value(std::to_string(TranspositionTable::defaultSize)))
+			("threads", "Number of threads used by the search", cxxopts::value(threads)->default_value("1"))
+			("search-mode", "How threads share the search: lazy (Lazy SMP, fastest), root-split (root moves split between threads, same result with any number of threads) or ybwc (idle threads join the nodes whose first move has been searched)",
+			 cxxopts::value<std::string>()->default_value("lazy"))
+			("no-null-move", "Disable null move pruning")
+			("no-lmr", "Disable late move reductions")
+			("no-rfp", "Disable reverse futility pruning")
+			("no-futility", "Disable futility pruning")
+			("no-aspiration", "Disable aspiration windows at the root")
+			("perft", "Count the leaf nodes of the tree of legal moves up to the given depth from the current position (--fen, or the initial board), print the count and exit. Uses --threads and a table of --hash megabytes", cxxopts::value(perftDepth)->default_value("0"))
+			("divide", "With --perft, also print the count of every legal move")
 			("h,help", "Display this help and exit");
 
 	try {
@@ -29,13 +50,58 @@ void argumentParser(int argc, char **argv, int &level, enumColor &enginePieces,
 
 		verbose = args.count("verbose") != 0;
 		pvp = args.count("pvp") != 0;
+		divide = args.count("divide") != 0;
+
+		features.nullMove = args.count("no-null-move") == 0;
+		features.lateMoveReductions = args.count("no-lmr") == 0;
+		features.reverseFutility = args.count("no-rfp") == 0;
+		features.futility = args.count("no-futility") == 0;
+		features.aspirationWindows = args.count("no-aspiration") == 0;
 
 		if (args.count("level")) {
 			if (args["level"].as<int>() > 10 || args["level"].as<int>() < 1) {
 				std::cout << "ChessQDL: Argument value is not valid" << std::endl;
 				exit(1);
 			} else level = args["level"].as<int>();
-		} else level = 3;
+		} else level = limits.isTimed() ? maxSearchDepth : 3;
+
+		if (limits.time < 0 || limits.increment < 0 || limits.movesToGo < 0 || limits.moveTime < 0) {
+			std::cout << "ChessQDL: Argument value is not valid" << std::endl;
+			exit(1);
+		}
+
+		if (hashSize < 1 || threads < 1 || perftDepth < 0) {
+			std::cout << "ChessQDL: Argument value is not valid" << std::endl;
+			exit(1);
+		}
+
+		std::string backend = args["slider-attacks"].as<std::string>();
+		if (backend == "magic")
+			MoveGenerator::setSliderBackend(backendMagic);
+		else if (backend == "pext") {
+			if (!MoveGenerator::setSliderBackend(backendPext))
+				std::cout << "ChessQDL: PEXT is not supported by this CPU, using magic bitboards" << std::endl;
+		} else if (backend == "auto")
+			MoveGenerator::setSliderBackend(backendAuto);
+		else {
+			std::cout << "ChessQDL: Argument value is not valid" << std::endl;
+			exit(1);
+		}
+
+		std::string mode = args["search-mode"].as<std::string>();
+		if (mode == "lazy")
+			searchMode = modeLazySmp;
+		else if (mode == "root-split")
+			searchMode = modeRootSplit;
+		else if (mode == "ybwc")
+			searchMode = modeYbwc;
+		else {
+			std::cout << "ChessQDL: Argument value is not valid" << std::endl;
+			exit(1);
+		}
+
+		if (verbose)
+			std::cout << "Slider attacks: " << (MoveGenerator::getSliderBackend() == backendPext ? "pext" : "magic") << std::endl;
 
 		if (args.count("play_as_black"))
 			enginePieces = nWhite;
@@ -1,5 +1,7 @@
 #include "gtest/gtest.h"
 #include "Engine/bitboard.hpp"
+#include "Engine/utils.hpp"
+#include "Engine/movegen.hpp"
 
 TEST(Bitboard, InitStandardChessBoard_Test) {
 	chessqdl::Bitboard board;
@@ -64,3 +66,167 @@ TEST(Bitboard, FENConstructor_Test) {
 
 }
 
+
+TEST(Bitboard, FENStateFields_Test) {
+	chessqdl::Bitboard board("r1bqk1nr/pppp1ppp/2n5/2b1p3/1PB1P3/5N2/P1PP1PPP/RNBQK2R b Kq b3 1 4");
+
+	EXPECT_EQ(board.getSideToMove(), chessqdl::nBlack);
+	EXPECT_EQ(board.getCastlingRights(), chessqdl::cWhiteKing | chessqdl::cBlackQueen);
+	EXPECT_EQ(board.getEpSquare(), chessqdl::b3);
+}
+
+TEST(Bitboard, DoUndoMove_Test) {
+	std::string fen = "r3k2r/1P6/8/3pP3/8/8/8/R3K2R w KQkq d6 0 1";
+	chessqdl::Bitboard board(fen);
+	chessqdl::Bitboard original(fen);
+
+	std::vector<chessqdl::Move> moves = {
+			chessqdl::Move(chessqdl::e5, chessqdl::d6, chessqdl::fEnPassant),
+			chessqdl::Move(chessqdl::e1, chessqdl::g1, chessqdl::fKingCastle),
+			chessqdl::Move(chessqdl::e1, chessqdl::c1, chessqdl::fQueenCastle),
+			chessqdl::Move(chessqdl::b7, chessqdl::a8, chessqdl::fPromoCapture + 3),
+			chessqdl::Move(chessqdl::a1, chessqdl::a8, chessqdl::fCapture)
+	};
+
+	for (auto mv : moves) {
+		board.doMove(mv);
+		EXPECT_EQ(board.getSideToMove(), chessqdl::nBlack);
+		EXPECT_EQ(board.getAllPieces(), board.getPieces(chessqdl::nWhite) | board.getPieces(chessqdl::nBlack));
+		board.undoMove();
+		EXPECT_EQ(board.getBitBoards(), original.getBitBoards());
+		EXPECT_EQ(board.getCastlingRights(), original.getCastlingRights());
+		EXPECT_EQ(board.getEpSquare(), original.getEpSquare());
+		EXPECT_EQ(board.getSideToMove(), chessqdl::nWhite);
+	}
+
+	board.doMove(chessqdl::Move(chessqdl::e5, chessqdl::d6, chessqdl::fEnPassant));
+	EXPECT_EQ(board.getPawns(chessqdl::nBlack), 0x0);
+	EXPECT_EQ(board.getEpSquare(), chessqdl::noSquare);
+	board.undoMove();
+
+	board.doMove(chessqdl::Move(chessqdl::e1, chessqdl::g1, chessqdl::fKingCastle));
+	EXPECT_EQ(board.getRooks(chessqdl::nWhite), (1L << chessqdl::a1) | (1L << chessqdl::f1));
+	EXPECT_EQ(board.getCastlingRights(), chessqdl::cBlackKing | chessqdl::cBlackQueen);
+	board.undoMove();
+
+	board.doMove(chessqdl::Move(chessqdl::b7, chessqdl::a8, chessqdl::fPromoCapture + 3));
+	EXPECT_EQ(board.getQueens(chessqdl::nWhite), 1L << chessqdl::a8);
+	EXPECT_EQ(board.pieceOn(chessqdl::a8), chessqdl::nQueen);
+	EXPECT_EQ(board.pieceOn(chessqdl::b7), chessqdl::nNoPiece);
+	EXPECT_EQ(board.getCastlingRights(), chessqdl::cWhiteKing | chessqdl::cWhiteQueen | chessqdl::cBlackKing);
+	board.undoMove();
+
+	EXPECT_EQ(board.getHistoryLength(), 0);
+}
+
+TEST(Bitboard, Mailbox_Test) {
+	chessqdl::Bitboard board("r1bqk1nr/pppp1ppp/2n5/2b1p3/1PB1P3/5N2/P1PP1PPP/RNBQK2R b KQkq b3 1 4");
+
+	for (int idx = 0; idx < 64; idx++) {
+		chessqdl::enumPiece piece = board.pieceOn(idx);
+
+		if (piece == chessqdl::nNoPiece)
+			EXPECT_FALSE(board.testBit(chessqdl::nColor, idx));
+		else
+			EXPECT_TRUE(board.testBit(piece, idx));
+	}
+
+	board.resetBit(chessqdl::nKnight, chessqdl::f3);
+	board.setBit(chessqdl::nBishop, chessqdl::f3);
+	EXPECT_EQ(board.pieceOn(chessqdl::f3), chessqdl::nBishop);
+
+	board.resetBit(chessqdl::nBishop, chessqdl::f3);
+	EXPECT_EQ(board.pieceOn(chessqdl::f3), chessqdl::nNoPiece);
+}
+
+TEST(Bitboard, Bitboard64Operations_Test) {
+	constexpr chessqdl::U64 corners = (chessqdl::U64(1) << chessqdl::a1) | (chessqdl::U64(1) << chessqdl::h8);
+	static_assert(corners.count() == 2, "constexpr population count");
+	static_assert(corners.lsb() == chessqdl::a1, "constexpr bit scan");
+
+	chessqdl::U64 bits = corners;
+	EXPECT_EQ(bits.popLsb(), chessqdl::a1);
+	EXPECT_EQ(bits.popLsb(), chessqdl::h8);
+	EXPECT_TRUE(bits.none());
+
+	bits.set(chessqdl::e4);
+	EXPECT_TRUE(bits.test(chessqdl::e4));
+	EXPECT_EQ(~bits & chessqdl::notAFile, 0xfefefefeeefefefe);
+	EXPECT_EQ(chessqdl::leastSignificantSetBit(0x80), 7);
+	EXPECT_EQ(chessqdl::posToStr(1L << chessqdl::e4), "e4");
+}
+
+TEST(Bitboard, ZobristKey_Test) {
+	chessqdl::Bitboard board;
+	EXPECT_EQ(board.getKey(), chessqdl::Bitboard("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1").getKey());
+
+	// Same position reached through different move orders
+	chessqdl::Bitboard other;
+	for (auto mv : {chessqdl::Move(chessqdl::e2, chessqdl::e3), chessqdl::Move(chessqdl::g8, chessqdl::f6), chessqdl::Move(chessqdl::g1, chessqdl::f3)})
+		board.doMove(mv);
+	for (auto mv : {chessqdl::Move(chessqdl::g1, chessqdl::f3), chessqdl::Move(chessqdl::g8, chessqdl::f6), chessqdl::Move(chessqdl::e2, chessqdl::e3)})
+		other.doMove(mv);
+	EXPECT_EQ(board.getKey(), other.getKey());
+	EXPECT_EQ(board.getKey(), chessqdl::Bitboard("rnbqkb1r/pppppppp/5n2/8/8/4PN2/PPPP1PPP/RNBQKB1R b KQkq - 0 1").getKey());
+
+	// Side to move, en passant square and castling rights are part of the key
+	EXPECT_NE(chessqdl::Bitboard("4k3/8/8/8/4P3/8/8/4K3 w - - 0 1").getKey(), chessqdl::Bitboard("4k3/8/8/8/4P3/8/8/4K3 b - - 0 1").getKey());
+	EXPECT_NE(chessqdl::Bitboard("4k3/8/8/8/4P3/8/8/4K3 b - e3 0 1").getKey(), chessqdl::Bitboard("4k3/8/8/8/4P3/8/8/4K3 b - - 0 1").getKey());
+	EXPECT_NE(chessqdl::Bitboard("r3k3/8/8/8/8/8/8/4K3 w q - 0 1").getKey(), chessqdl::Bitboard("r3k3/8/8/8/8/8/8/4K3 w - - 0 1").getKey());
+
+	// The incremental key matches the key computed from scratch after every kind of move, and is restored by undoMove
+	chessqdl::Bitboard kiwipete("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+	uint64_t initialKey = kiwipete.getKey();
+	for (auto mv : chessqdl::MoveGenerator::getLegalMoves(kiwipete)) {
+		kiwipete.doMove(mv);
+		EXPECT_EQ(kiwipete.getKey(), kiwipete.computeKey()) << mv.toString();
+		for (auto reply : chessqdl::MoveGenerator::getLegalMoves(kiwipete)) {
+			kiwipete.doMove(reply);
+			EXPECT_EQ(kiwipete.getKey(), kiwipete.computeKey()) << mv.toString() << " " << reply.toString();
+			kiwipete.undoMove();
+		}
+		kiwipete.undoMove();
+		EXPECT_EQ(kiwipete.getKey(), initialKey);
+	}
+}
+
+TEST(Bitboard, NullMove_Test) {
+	chessqdl::Bitboard board("4k3/8/8/8/4P3/8/8/4K3 b - e3 0 1");
+	uint64_t initialKey = board.getKey();
+
+	// Passing the turn changes the side to move and clears the en passant square
+	board.doNullMove();
+	EXPECT_EQ(board.getSideToMove(), chessqdl::nWhite);
+	EXPECT_EQ(board.getEpSquare(), chessqdl::noSquare);
+	EXPECT_FALSE(board.getLastMove().isValid());
+	EXPECT_EQ(board.getKey(), chessqdl::Bitboard("4k3/8/8/8/4P3/8/8/4K3 w - - 0 1").getKey());
+
+	board.undoNullMove();
+	EXPECT_EQ(board.getSideToMove(), chessqdl::nBlack);
+	EXPECT_EQ(board.getEpSquare(), chessqdl::e3);
+	EXPECT_EQ(board.getKey(), initialKey);
+	EXPECT_EQ(board.getHistoryLength(), 0);
+}
+
+TEST(Bitboard, CopyKeepsHistory_Test) {
+	chessqdl::Bitboard board;
+	auto moves = chessqdl::MoveGenerator::getLegalMoves(board);
+	board.doMove(moves[0]);
+
+	// A copy takes its moves back on its own, and the original is not changed
+	chessqdl::Bitboard copy = board;
+	EXPECT_EQ(copy.getHistoryLength(), 1);
+	EXPECT_EQ(copy.getLastMove(), moves[0]);
+	EXPECT_EQ(copy.getKey(), board.getKey());
+
+	copy.undoMove();
+	EXPECT_EQ(copy.getKey(), chessqdl::Bitboard().getKey());
+	EXPECT_EQ(board.getHistoryLength(), 1);
+
+	// Assignment replaces the whole history
+	copy.doMove(moves[1]);
+	copy.doMove(chessqdl::MoveGenerator::getLegalMoves(copy)[0]);
+	copy = board;
+	EXPECT_EQ(copy.getHistoryLength(), 1);
+	EXPECT_EQ(copy.getLastMove(), moves[0]);
+}
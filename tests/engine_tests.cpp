@@ -0,0 +1,214 @@
+#include "gtest/gtest.h"
+#include "Engine/engine.hpp"
+
+#include <chrono>
+#include <thread>
+
+TEST(Engine, MateInOne_Test) {
+	chessqdl::Engine engine("6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1", chessqdl::nWhite, 3, false, false);
+	EXPECT_EQ(engine.getBestMove(3, chessqdl::nWhite).toString(), "a1a8");
+
+	chessqdl::Engine black("r5k1/8/8/8/8/8/5PPP/6K1 b - - 0 1", chessqdl::nBlack, 3, false, false);
+	EXPECT_EQ(black.getBestMove(3, chessqdl::nBlack).toString(), "a8a1");
+}
+
+TEST(Engine, IterativeDeepeningStop_Test) {
+	chessqdl::Engine engine(chessqdl::nWhite, 20, false, false);
+
+	// Stopped long before depth 20 is reached, the search still returns a legal move
+	std::thread stopper([&engine] {
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		engine.stop();
+	});
+	chessqdl::Move mv = engine.getBestMove(20, chessqdl::nWhite);
+	stopper.join();
+
+	EXPECT_TRUE(chessqdl::MoveGenerator::getLegalMoves(chessqdl::Bitboard()).contains(mv));
+	EXPECT_FALSE(engine.getPrincipalVariation(20).empty());
+	EXPECT_EQ(engine.getPrincipalVariation(20)[0], mv);
+}
+
+TEST(Engine, ScoreToString_Test) {
+	EXPECT_EQ(chessqdl::Engine::scoreToString(3), "3");
+	EXPECT_EQ(chessqdl::Engine::scoreToString(chessqdl::scoreMate - 1), "mate 1");
+	EXPECT_EQ(chessqdl::Engine::scoreToString(chessqdl::scoreMate - 3), "mate 2");
+	EXPECT_EQ(chessqdl::Engine::scoreToString(-chessqdl::scoreMate + 2), "mate -1");
+}
+
+TEST(Engine, TimeManagerLimits_Test) {
+	chessqdl::TimeManager timeManager;
+	chessqdl::SearchLimits limits;
+
+	timeManager.start(limits);
+	EXPECT_FALSE(timeManager.hardLimitReached());
+	EXPECT_FALSE(timeManager.softLimitReached());
+
+	limits.moveTime = 500;
+	timeManager.start(limits);
+	EXPECT_EQ(timeManager.getSoftLimit(), timeManager.getHardLimit());
+	EXPECT_LT(timeManager.getHardLimit(), 500);
+
+	// The clock is split between the moves to go, and the last move may use all of it but the overhead
+	limits = chessqdl::SearchLimits();
+	limits.time = 60000;
+	limits.increment = 1000;
+	timeManager.start(limits);
+	EXPECT_EQ(timeManager.getSoftLimit(), 60000 / 30 + 750);
+	EXPECT_EQ(timeManager.getHardLimit(), 4 * timeManager.getSoftLimit());
+
+	limits.movesToGo = 1;
+	timeManager.start(limits);
+	EXPECT_LT(timeManager.getHardLimit(), 60000);
+	EXPECT_GT(timeManager.getHardLimit(), 59000);
+
+	// Never more than the clock, even with a large increment
+	limits = chessqdl::SearchLimits();
+	limits.time = 100;
+	limits.increment = 5000;
+	timeManager.start(limits);
+	EXPECT_LT(timeManager.getHardLimit(), 100);
+}
+
+TEST(Engine, TimedSearch_Test) {
+	chessqdl::Engine engine(chessqdl::nWhite, chessqdl::maxSearchDepth, false, false);
+	chessqdl::SearchLimits limits;
+	limits.moveTime = 300;
+	engine.setLimits(limits);
+
+	auto begin = std::chrono::steady_clock::now();
+	chessqdl::Move mv = engine.getBestMove(chessqdl::maxSearchDepth, chessqdl::nWhite);
+	auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin).count();
+
+	EXPECT_TRUE(chessqdl::MoveGenerator::getLegalMoves(chessqdl::Bitboard()).contains(mv));
+	EXPECT_LT(elapsed, 600);
+}
+
+TEST(Engine, Quiescence_Test) {
+	// At depth 1 the queen would take the pawn if the recapture was not searched
+	chessqdl::Engine engine("4k3/8/4p3/3p4/8/8/8/3QK3 w - - 0 1", chessqdl::nWhite, 1, false, false);
+	EXPECT_NE(engine.getBestMove(1, chessqdl::nWhite).toString(), "d1d5");
+
+	// Undefended pieces are still taken
+	chessqdl::Engine capture("4k3/8/8/3r4/8/8/8/3QK3 w - - 0 1", chessqdl::nWhite, 1, false, false);
+	EXPECT_EQ(capture.getBestMove(1, chessqdl::nWhite).toString(), "d1d5");
+}
+
+TEST(Engine, SelectiveSearch_Test) {
+	// Mate in 2 with a quiet first move: every combination of the pruning techniques finds it
+	for (int mask = 0; mask < 16; mask++) {
+		chessqdl::SearchFeatures features;
+		features.nullMove = mask & 1;
+		features.lateMoveReductions = mask & 2;
+		features.reverseFutility = mask & 4;
+		features.futility = mask & 8;
+
+		chessqdl::Engine engine("r1b2k1r/ppp1bppp/8/1B1Q4/5q2/2P5/PPP2PPP/R3R1K1 w - - 1 0", chessqdl::nWhite, 4, false, false);
+		engine.setFeatures(features);
+		EXPECT_EQ(engine.getBestMove(4, chessqdl::nWhite).toString(), "d5d8") << mask;
+	}
+
+	// The reductions and pruning make the same depth much cheaper to reach
+	chessqdl::SearchFeatures none;
+	none.nullMove = none.lateMoveReductions = none.reverseFutility = none.futility = false;
+	long nodes[2];
+	for (int i = 0; i < 2; i++) {
+		chessqdl::Engine engine("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", chessqdl::nWhite, 5, false, false);
+		if (i == 1)
+			engine.setFeatures(none);
+		engine.getBestMove(5, chessqdl::nWhite);
+		nodes[i] = engine.getNodesVisited();
+	}
+	EXPECT_LT(nodes[0], nodes[1]);
+}
+
+TEST(Engine, AspirationWindows_Test) {
+	// The narrow windows do not change the move chosen, nor miss a mate found at the same depth
+	for (auto fen : {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "r2q1rk1/pp2bppp/2n1bn2/3p4/3P4/2NBPN2/PP3PPP/R1BQ1RK1 w - - 0 1",
+					 "r1b2k1r/ppp1bppp/8/1B1Q4/5q2/2P5/PPP2PPP/R3R1K1 w - - 1 0"}) {
+		std::string moves[2];
+		for (int i = 0; i < 2; i++) {
+			chessqdl::SearchFeatures features;
+			features.aspirationWindows = i == 0;
+
+			chessqdl::Engine engine(fen, chessqdl::nWhite, 6, false, false);
+			engine.setFeatures(features);
+			moves[i] = engine.getBestMove(6, chessqdl::nWhite).toString();
+		}
+		EXPECT_EQ(moves[0], moves[1]) << fen;
+	}
+}
+
+TEST(Engine, LazySMP_Test) {
+	// Helper threads share the transposition table, and the result is still found
+	chessqdl::Engine engine("r1b2k1r/ppp1bppp/8/1B1Q4/5q2/2P5/PPP2PPP/R3R1K1 w - - 1 0", chessqdl::nWhite, 5, false, false);
+	engine.setThreads(4);
+	EXPECT_EQ(engine.getBestMove(5, chessqdl::nWhite).toString(), "d5d8");
+
+	// Stopping the search stops the helpers too
+	chessqdl::Engine parallel(chessqdl::nWhite, 20, false, false);
+	parallel.setThreads(3);
+	std::thread stopper([&parallel] {
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		parallel.stop();
+	});
+	chessqdl::Move mv = parallel.getBestMove(20, chessqdl::nWhite);
+	stopper.join();
+	EXPECT_TRUE(chessqdl::MoveGenerator::getLegalMoves(chessqdl::Bitboard()).contains(mv));
+}
+
+TEST(Engine, RootSplitDeterminism_Test) {
+	// The same position and depth give the same move, line and node count with any number of threads
+	std::vector<chessqdl::Move> lines[3];
+	long nodes[3];
+	for (int i = 0; i < 3; i++) {
+		chessqdl::Engine engine("r2q1rk1/pp2bppp/2n1bn2/3p4/3P4/2NBPN2/PP3PPP/R1BQ1RK1 w - - 0 1", chessqdl::nWhite, 5, false, false);
+		engine.setSearchMode(chessqdl::modeRootSplit);
+		// A small table fills up, so entries are replaced as well
+		engine.setHashSize(1);
+		engine.setThreads(1 + 2 * i);
+		engine.getBestMove(5, chessqdl::nWhite);
+		lines[i] = engine.getPrincipalVariation(chessqdl::maxSearchPly);
+		nodes[i] = engine.getNodesVisited();
+
+		// The next search reuses the tables, emptied
+		engine.getBestMove(5, chessqdl::nWhite);
+		EXPECT_EQ(engine.getNodesVisited(), nodes[i]);
+	}
+	EXPECT_FALSE(lines[0].empty());
+	EXPECT_EQ(lines[0], lines[1]);
+	EXPECT_EQ(lines[0], lines[2]);
+	EXPECT_EQ(nodes[0], nodes[1]);
+	EXPECT_EQ(nodes[0], nodes[2]);
+
+	// Mates are still found
+	chessqdl::Engine mate("r1b2k1r/ppp1bppp/8/1B1Q4/5q2/2P5/PPP2PPP/R3R1K1 w - - 1 0", chessqdl::nWhite, 4, false, false);
+	mate.setSearchMode(chessqdl::modeRootSplit);
+	mate.setThreads(2);
+	EXPECT_EQ(mate.getBestMove(4, chessqdl::nWhite).toString(), "d5d8");
+}
+
+TEST(Engine, YbwcSearch_Test) {
+	// Mates are found with helpers joining the split points
+	chessqdl::Engine mate("r1b2k1r/ppp1bppp/8/1B1Q4/5q2/2P5/PPP2PPP/R3R1K1 w - - 1 0", chessqdl::nWhite, 5, false, false);
+	mate.setSearchMode(chessqdl::modeYbwc);
+	mate.setThreads(3);
+	EXPECT_EQ(mate.getBestMove(5, chessqdl::nWhite).toString(), "d5d8");
+
+	// The line reported is legal, and the engine can search again after the helpers are gone
+	chessqdl::Engine engine("r2q1rk1/pp2bppp/2n1bn2/3p4/3P4/2NBPN2/PP3PPP/R1BQ1RK1 w - - 0 1", chessqdl::nWhite, 6, false, false);
+	engine.setSearchMode(chessqdl::modeYbwc);
+	engine.setThreads(4);
+	for (int i = 0; i < 2; i++) {
+		engine.getBestMove(6, chessqdl::nWhite);
+		std::vector<chessqdl::Move> line = engine.getPrincipalVariation(chessqdl::maxSearchPly);
+		ASSERT_FALSE(line.empty());
+
+		chessqdl::Bitboard board("r2q1rk1/pp2bppp/2n1bn2/3p4/3P4/2NBPN2/PP3PPP/R1BQ1RK1 w - - 0 1");
+		for (chessqdl::Move mv : line) {
+			chessqdl::MoveList moves;
+			chessqdl::MoveGenerator::getLegalMoves(board, moves);
+			ASSERT_TRUE(moves.contains(mv)) << mv.toString();
+			board.doMove(mv);
+		}
+	}
+}
@@ -1,11 +1,24 @@
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 
+#include <random>
+
 #include "Engine/movegen.hpp"
 #include "Engine/bitboard.hpp"
 #include "Engine/utils.hpp"
-
-//FIXME: These tests do not take into account the possibility of castles or en passant captures
+#include "Engine/attacks.hpp"
+#include "Engine/movepick.hpp"
+
+/**
+ * @brief Converts a list of moves to their string representation, so they can be compared with the expected moves
+ */
+template<typename MoveContainer>
+std::vector<std::string> toStrings(const MoveContainer &moves) {
+	std::vector<std::string> names;
+	for (const auto &mv : moves)
+		names.push_back(mv.toString());
+	return names;
+}
 
 TEST(MoveGenerator, PseudoLegalInitialMoves_Test) {
 
@@ -61,9 +74,10 @@ TEST(MoveGenerator, PawnPromotionAWhite_Test) {
 	chessqdl::MoveGenerator generator;
 
 	chessqdl::U64 moves = generator.getPawnMoves(board.getBitBoards(), chessqdl::nWhite);
-	std::vector<std::string> promotions = generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nWhite).to_ullong()));
+	chessqdl::MoveList promotions;
+	generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nWhite).to_ullong()), promotions);
 
-	EXPECT_THAT(promotions, testing::ElementsAre("a7a8n", "a7a8b", "a7a8r", "a7a8q", "a7b8n", "a7b8b", "a7b8r", "a7b8q"));
+	EXPECT_THAT(toStrings(promotions), testing::ElementsAre("a7a8n", "a7a8b", "a7a8r", "a7a8q", "a7b8n", "a7b8b", "a7b8r", "a7b8q"));
 	EXPECT_EQ(moves, 0x0);
 }
 
@@ -72,9 +86,10 @@ TEST(MoveGenerator, PawnPromotionBWhite_Test) {
 	chessqdl::MoveGenerator generator;
 
 	chessqdl::U64 moves = generator.getPawnMoves(board.getBitBoards(), chessqdl::nWhite);
-	std::vector<std::string> promotions = generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nWhite).to_ullong()));
+	chessqdl::MoveList promotions;
+	generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nWhite).to_ullong()), promotions);
 
-	EXPECT_THAT(promotions, testing::ElementsAre("b7a8n", "b7a8b", "b7a8r", "b7a8q", "b7b8n", "b7b8b", "b7b8r", "b7b8q", "b7c8n", "b7c8b", "b7c8r", "b7c8q"));
+	EXPECT_THAT(toStrings(promotions), testing::ElementsAre("b7a8n", "b7a8b", "b7a8r", "b7a8q", "b7b8n", "b7b8b", "b7b8r", "b7b8q", "b7c8n", "b7c8b", "b7c8r", "b7c8q"));
 	EXPECT_EQ(moves, 0x0);
 }
 
@@ -84,9 +99,10 @@ TEST(MoveGenerator, PawnPromotionCWhite_Test) {
 	chessqdl::MoveGenerator generator;
 
 	chessqdl::U64 moves = generator.getPawnMoves(board.getBitBoards(), chessqdl::nWhite);
-	std::vector<std::string> promotions = generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nWhite).to_ullong()));
+	chessqdl::MoveList promotions;
+	generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nWhite).to_ullong()), promotions);
 
-	EXPECT_THAT(promotions, testing::ElementsAre("c7b8n", "c7b8b", "c7b8r", "c7b8q", "c7c8n", "c7c8b", "c7c8r", "c7c8q", "c7d8n", "c7d8b", "c7d8r", "c7d8q"));
+	EXPECT_THAT(toStrings(promotions), testing::ElementsAre("c7b8n", "c7b8b", "c7b8r", "c7b8q", "c7c8n", "c7c8b", "c7c8r", "c7c8q", "c7d8n", "c7d8b", "c7d8r", "c7d8q"));
 	EXPECT_EQ(moves, 0x0);
 }
 
@@ -95,9 +111,10 @@ TEST(MoveGenerator, PawnPromotionDWhite_Test) {
 	chessqdl::MoveGenerator generator;
 
 	chessqdl::U64 moves = generator.getPawnMoves(board.getBitBoards(), chessqdl::nWhite);
-	std::vector<std::string> promotions = generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nWhite).to_ullong()));
+	chessqdl::MoveList promotions;
+	generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nWhite).to_ullong()), promotions);
 
-	EXPECT_THAT(promotions, testing::ElementsAre("d7c8n", "d7c8b", "d7c8r", "d7c8q", "d7d8n", "d7d8b", "d7d8r", "d7d8q", "d7e8n", "d7e8b", "d7e8r", "d7e8q"));
+	EXPECT_THAT(toStrings(promotions), testing::ElementsAre("d7c8n", "d7c8b", "d7c8r", "d7c8q", "d7d8n", "d7d8b", "d7d8r", "d7d8q", "d7e8n", "d7e8b", "d7e8r", "d7e8q"));
 	EXPECT_EQ(moves, 0x0);
 }
 
@@ -107,9 +124,10 @@ TEST(MoveGenerator, PawnPromotionEWhite_Test) {
 	chessqdl::MoveGenerator generator;
 
 	chessqdl::U64 moves = generator.getPawnMoves(board.getBitBoards(), chessqdl::nWhite);
-	std::vector<std::string> promotions = generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nWhite).to_ullong()));
+	chessqdl::MoveList promotions;
+	generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nWhite).to_ullong()), promotions);
 
-	EXPECT_THAT(promotions, testing::ElementsAre("e7d8n", "e7d8b", "e7d8r", "e7d8q", "e7e8n", "e7e8b", "e7e8r", "e7e8q", "e7f8n", "e7f8b", "e7f8r", "e7f8q"));
+	EXPECT_THAT(toStrings(promotions), testing::ElementsAre("e7d8n", "e7d8b", "e7d8r", "e7d8q", "e7e8n", "e7e8b", "e7e8r", "e7e8q", "e7f8n", "e7f8b", "e7f8r", "e7f8q"));
 	EXPECT_EQ(moves, 0x0);
 }
 
@@ -119,9 +137,10 @@ TEST(MoveGenerator, PawnPromotionFWhite_Test) {
 	chessqdl::MoveGenerator generator;
 
 	chessqdl::U64 moves = generator.getPawnMoves(board.getBitBoards(), chessqdl::nWhite);
-	std::vector<std::string> promotions = generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nWhite).to_ullong()));
+	chessqdl::MoveList promotions;
+	generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nWhite).to_ullong()), promotions);
 
-	EXPECT_THAT(promotions, testing::ElementsAre("f7e8n", "f7e8b", "f7e8r", "f7e8q", "f7f8n", "f7f8b", "f7f8r", "f7f8q", "f7g8n", "f7g8b", "f7g8r", "f7g8q"));
+	EXPECT_THAT(toStrings(promotions), testing::ElementsAre("f7e8n", "f7e8b", "f7e8r", "f7e8q", "f7f8n", "f7f8b", "f7f8r", "f7f8q", "f7g8n", "f7g8b", "f7g8r", "f7g8q"));
 	EXPECT_EQ(moves, 0x0);
 }
 
@@ -131,9 +150,10 @@ TEST(MoveGenerator, PawnPromotionGWhite_Test) {
 	chessqdl::MoveGenerator generator;
 
 	chessqdl::U64 moves = generator.getPawnMoves(board.getBitBoards(), chessqdl::nWhite);
-	std::vector<std::string> promotions = generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nWhite).to_ullong()));
+	chessqdl::MoveList promotions;
+	generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nWhite).to_ullong()), promotions);
 
-	EXPECT_THAT(promotions, testing::ElementsAre("g7f8n", "g7f8b", "g7f8r", "g7f8q", "g7g8n", "g7g8b", "g7g8r", "g7g8q", "g7h8n", "g7h8b", "g7h8r", "g7h8q"));
+	EXPECT_THAT(toStrings(promotions), testing::ElementsAre("g7f8n", "g7f8b", "g7f8r", "g7f8q", "g7g8n", "g7g8b", "g7g8r", "g7g8q", "g7h8n", "g7h8b", "g7h8r", "g7h8q"));
 	EXPECT_EQ(moves, 0x0);
 }
 
@@ -143,9 +163,10 @@ TEST(MoveGenerator, PawnPromotionHWhite_Test) {
 	chessqdl::MoveGenerator generator;
 
 	chessqdl::U64 moves = generator.getPawnMoves(board.getBitBoards(), chessqdl::nWhite);
-	std::vector<std::string> promotions = generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nWhite).to_ullong()));
+	chessqdl::MoveList promotions;
+	generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nWhite).to_ullong()), promotions);
 
-	EXPECT_THAT(promotions, testing::ElementsAre("h7g8n", "h7g8b", "h7g8r", "h7g8q", "h7h8n", "h7h8b", "h7h8r", "h7h8q"));
+	EXPECT_THAT(toStrings(promotions), testing::ElementsAre("h7g8n", "h7g8b", "h7g8r", "h7g8q", "h7h8n", "h7h8b", "h7h8r", "h7h8q"));
 	EXPECT_EQ(moves, 0x0);
 }
 
@@ -154,9 +175,10 @@ TEST(MoveGenerator, PawnPromotionABlack_Test) {
 	chessqdl::MoveGenerator generator;
 
 	chessqdl::U64 moves = generator.getPawnMoves(board.getBitBoards(), chessqdl::nBlack);
-	std::vector<std::string> promotions = generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nBlack).to_ullong()));
+	chessqdl::MoveList promotions;
+	generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nBlack).to_ullong()), promotions);
 
-	EXPECT_THAT(promotions, testing::ElementsAre("a2a1n", "a2a1b", "a2a1r", "a2a1q", "a2b1n", "a2b1b", "a2b1r", "a2b1q"));
+	EXPECT_THAT(toStrings(promotions), testing::ElementsAre("a2a1n", "a2a1b", "a2a1r", "a2a1q", "a2b1n", "a2b1b", "a2b1r", "a2b1q"));
 	EXPECT_EQ(moves, 0x0);
 }
 
@@ -165,9 +187,10 @@ TEST(MoveGenerator, PawnPromotionBBlack_Test) {
 	chessqdl::MoveGenerator generator;
 
 	chessqdl::U64 moves = generator.getPawnMoves(board.getBitBoards(), chessqdl::nBlack);
-	std::vector<std::string> promotions = generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nBlack).to_ullong()));
+	chessqdl::MoveList promotions;
+	generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nBlack).to_ullong()), promotions);
 
-	EXPECT_THAT(promotions, testing::ElementsAre("b2a1n", "b2a1b", "b2a1r", "b2a1q", "b2b1n", "b2b1b", "b2b1r", "b2b1q", "b2c1n", "b2c1b", "b2c1r", "b2c1q"));
+	EXPECT_THAT(toStrings(promotions), testing::ElementsAre("b2a1n", "b2a1b", "b2a1r", "b2a1q", "b2b1n", "b2b1b", "b2b1r", "b2b1q", "b2c1n", "b2c1b", "b2c1r", "b2c1q"));
 	EXPECT_EQ(moves, 0x0);
 }
 
@@ -176,9 +199,10 @@ TEST(MoveGenerator, PawnPromotionCBlack_Test) {
 	chessqdl::MoveGenerator generator;
 
 	chessqdl::U64 moves = generator.getPawnMoves(board.getBitBoards(), chessqdl::nBlack);
-	std::vector<std::string> promotions = generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nBlack).to_ullong()));
+	chessqdl::MoveList promotions;
+	generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nBlack).to_ullong()), promotions);
 
-	EXPECT_THAT(promotions, testing::ElementsAre("c2b1n", "c2b1b", "c2b1r", "c2b1q", "c2c1n", "c2c1b", "c2c1r", "c2c1q", "c2d1n", "c2d1b", "c2d1r", "c2d1q"));
+	EXPECT_THAT(toStrings(promotions), testing::ElementsAre("c2b1n", "c2b1b", "c2b1r", "c2b1q", "c2c1n", "c2c1b", "c2c1r", "c2c1q", "c2d1n", "c2d1b", "c2d1r", "c2d1q"));
 	EXPECT_EQ(moves, 0x0);
 }
 
@@ -187,9 +211,10 @@ TEST(MoveGenerator, PawnPromotionDBlack_Test) {
 	chessqdl::MoveGenerator generator;
 
 	chessqdl::U64 moves = generator.getPawnMoves(board.getBitBoards(), chessqdl::nBlack);
-	std::vector<std::string> promotions = generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nBlack).to_ullong()));
+	chessqdl::MoveList promotions;
+	generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nBlack).to_ullong()), promotions);
 
-	EXPECT_THAT(promotions, testing::ElementsAre("d2c1n", "d2c1b", "d2c1r", "d2c1q", "d2d1n", "d2d1b", "d2d1r", "d2d1q", "d2e1n", "d2e1b", "d2e1r", "d2e1q"));
+	EXPECT_THAT(toStrings(promotions), testing::ElementsAre("d2c1n", "d2c1b", "d2c1r", "d2c1q", "d2d1n", "d2d1b", "d2d1r", "d2d1q", "d2e1n", "d2e1b", "d2e1r", "d2e1q"));
 	EXPECT_EQ(moves, 0x0);
 }
 
@@ -198,9 +223,10 @@ TEST(MoveGenerator, PawnPromotionEBlack_Test) {
 	chessqdl::MoveGenerator generator;
 
 	chessqdl::U64 moves = generator.getPawnMoves(board.getBitBoards(), chessqdl::nBlack);
-	std::vector<std::string> promotions = generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nBlack).to_ullong()));
+	chessqdl::MoveList promotions;
+	generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nBlack).to_ullong()), promotions);
 
-	EXPECT_THAT(promotions, testing::ElementsAre("e2d1n", "e2d1b", "e2d1r", "e2d1q", "e2e1n", "e2e1b", "e2e1r", "e2e1q", "e2f1n", "e2f1b", "e2f1r", "e2f1q"));
+	EXPECT_THAT(toStrings(promotions), testing::ElementsAre("e2d1n", "e2d1b", "e2d1r", "e2d1q", "e2e1n", "e2e1b", "e2e1r", "e2e1q", "e2f1n", "e2f1b", "e2f1r", "e2f1q"));
 	EXPECT_EQ(moves, 0x0);
 }
 
@@ -209,9 +235,10 @@ TEST(MoveGenerator, PawnPromotionFBlack_Test) {
 	chessqdl::MoveGenerator generator;
 
 	chessqdl::U64 moves = generator.getPawnMoves(board.getBitBoards(), chessqdl::nBlack);
-	std::vector<std::string> promotions = generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nBlack).to_ullong()));
+	chessqdl::MoveList promotions;
+	generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nBlack).to_ullong()), promotions);
 
-	EXPECT_THAT(promotions, testing::ElementsAre("f2e1n", "f2e1b", "f2e1r", "f2e1q", "f2f1n", "f2f1b", "f2f1r", "f2f1q", "f2g1n", "f2g1b", "f2g1r", "f2g1q"));
+	EXPECT_THAT(toStrings(promotions), testing::ElementsAre("f2e1n", "f2e1b", "f2e1r", "f2e1q", "f2f1n", "f2f1b", "f2f1r", "f2f1q", "f2g1n", "f2g1b", "f2g1r", "f2g1q"));
 	EXPECT_EQ(moves, 0x0);
 }
 
@@ -220,9 +247,10 @@ TEST(MoveGenerator, PawnPromotionGBlack_Test) {
 	chessqdl::MoveGenerator generator;
 
 	chessqdl::U64 moves = generator.getPawnMoves(board.getBitBoards(), chessqdl::nBlack);
-	std::vector<std::string> promotions = generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nBlack).to_ullong()));
+	chessqdl::MoveList promotions;
+	generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nBlack).to_ullong()), promotions);
 
-	EXPECT_THAT(promotions, testing::ElementsAre("g2f1n", "g2f1b", "g2f1r", "g2f1q", "g2g1n", "g2g1b", "g2g1r", "g2g1q", "g2h1n", "g2h1b", "g2h1r", "g2h1q"));
+	EXPECT_THAT(toStrings(promotions), testing::ElementsAre("g2f1n", "g2f1b", "g2f1r", "g2f1q", "g2g1n", "g2g1b", "g2g1r", "g2g1q", "g2h1n", "g2h1b", "g2h1r", "g2h1q"));
 	EXPECT_EQ(moves, 0x0);
 }
 
@@ -231,8 +259,337 @@ TEST(MoveGenerator, PawnPromotionHBlack_Test) {
 	chessqdl::MoveGenerator generator;
 
 	chessqdl::U64 moves = generator.getPawnMoves(board.getBitBoards(), chessqdl::nBlack);
-	std::vector<std::string> promotions = generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nBlack).to_ullong()));
+	chessqdl::MoveList promotions;
+	generator.getPawnPromotions(moves, 1L << chessqdl::leastSignificantSetBit(board.getPawns(chessqdl::nBlack).to_ullong()), promotions);
 
-	EXPECT_THAT(promotions, testing::ElementsAre("h2g1n", "h2g1b", "h2g1r", "h2g1q", "h2h1n", "h2h1b", "h2h1r", "h2h1q"));
+	EXPECT_THAT(toStrings(promotions), testing::ElementsAre("h2g1n", "h2g1b", "h2g1r", "h2g1q", "h2h1n", "h2h1b", "h2h1r", "h2h1q"));
 	EXPECT_EQ(moves, 0x0);
 }
+
+TEST(MoveGenerator, MoveEncoding_Test) {
+	chessqdl::Move move(chessqdl::e7, chessqdl::d8, chessqdl::fPromoCapture + 3);
+
+	EXPECT_EQ(move.getFrom(), chessqdl::e7);
+	EXPECT_EQ(move.getTo(), chessqdl::d8);
+	EXPECT_TRUE(move.isCapture());
+	EXPECT_TRUE(move.isPromotion());
+	EXPECT_EQ(move.getPromotion(), chessqdl::nQueen);
+	EXPECT_EQ(move.toString(), "e7d8q");
+	EXPECT_FALSE(chessqdl::Move().isValid());
+
+	chessqdl::Bitboard board("r1bqk1nr/pppp1ppp/2n5/2b1p3/1PB1P3/5N2/P1PP1PPP/RNBQK2R b KQkq b3 1 4");
+	auto moves = chessqdl::MoveGenerator::getPseudoLegalMoves(board.getBitBoards(), chessqdl::nBlack);
+
+	EXPECT_TRUE(moves.contains(chessqdl::Move(chessqdl::c5, chessqdl::b4, chessqdl::fCapture)));
+	EXPECT_TRUE(moves.contains(chessqdl::Move(chessqdl::a7, chessqdl::a5, chessqdl::fDoublePush)));
+	EXPECT_TRUE(moves.contains(chessqdl::Move(chessqdl::a7, chessqdl::a6, chessqdl::fQuiet)));
+}
+
+TEST(MoveGenerator, CountPseudoLegalMoves_Test) {
+	chessqdl::Bitboard evans("r1bqk1nr/pppp1ppp/2n5/2b1p3/1PB1P3/5N2/P1PP1PPP/RNBQK2R b KQkq b3 1 4");
+	chessqdl::Bitboard promotion("r1r1k3/1P6/8/8/8/8/8/4K3 w - - 0 1");
+
+	for (auto board : {evans, promotion}) {
+		for (auto color : {chessqdl::nWhite, chessqdl::nBlack}) {
+			EXPECT_EQ(chessqdl::MoveGenerator::countPseudoLegalMoves(board.getBitBoards(), color),
+					  chessqdl::MoveGenerator::getPseudoLegalMoves(board.getBitBoards(), color).size());
+		}
+	}
+}
+
+TEST(MoveGenerator, MagicAttacksMatchKoggeStone_Test) {
+	std::mt19937_64 rng(2020);
+
+	for (int idx = 0; idx < 64; idx++) {
+		for (int i = 0; i < 200; i++) {
+			chessqdl::U64 slider = chessqdl::U64(1) << idx;
+			chessqdl::U64 blockers = rng() & rng() & ~slider.to_ullong();
+
+			chessqdl::BitbArray bitboard{};
+			bitboard[chessqdl::nWhite] = slider;
+			bitboard[chessqdl::nBlack] = blockers;
+			bitboard[chessqdl::nColor] = slider | blockers;
+			bitboard[chessqdl::nBishop] = slider;
+			bitboard[chessqdl::nRook] = slider;
+
+			EXPECT_EQ(chessqdl::MoveGenerator::bishopAttacks(idx, bitboard[chessqdl::nColor]) & ~slider,
+					  chessqdl::MoveGenerator::getBishopMoves(bitboard, chessqdl::nWhite));
+			EXPECT_EQ(chessqdl::MoveGenerator::rookAttacks(idx, bitboard[chessqdl::nColor]) & ~slider,
+					  chessqdl::MoveGenerator::getRookMoves(bitboard, chessqdl::nWhite));
+		}
+	}
+}
+
+TEST(MoveGenerator, SliderBackendsAgree_Test) {
+	if (!chessqdl::MoveGenerator::isPextSupported())
+		GTEST_SKIP() << "PEXT is not supported by this CPU";
+
+	std::mt19937_64 rng(2021);
+	chessqdl::enumSliderBackend original = chessqdl::MoveGenerator::getSliderBackend();
+
+	for (int idx = 0; idx < 64; idx++) {
+		for (int i = 0; i < 200; i++) {
+			chessqdl::U64 occupancy = rng() & rng();
+
+			chessqdl::MoveGenerator::setSliderBackend(chessqdl::backendMagic);
+			chessqdl::U64 magicBishop = chessqdl::MoveGenerator::bishopAttacks(idx, occupancy);
+			chessqdl::U64 magicRook = chessqdl::MoveGenerator::rookAttacks(idx, occupancy);
+
+			ASSERT_TRUE(chessqdl::MoveGenerator::setSliderBackend(chessqdl::backendPext));
+			EXPECT_EQ(chessqdl::MoveGenerator::bishopAttacks(idx, occupancy), magicBishop);
+			EXPECT_EQ(chessqdl::MoveGenerator::rookAttacks(idx, occupancy), magicRook);
+		}
+	}
+
+	chessqdl::MoveGenerator::setSliderBackend(original);
+}
+
+TEST(MoveGenerator, AttackTablesMatchSetWise_Test) {
+	static_assert(chessqdl::knightAttacks[chessqdl::a1] == ((1L << chessqdl::b3) | (1L << chessqdl::c2)), "knight table is built at compile time");
+	static_assert(chessqdl::pawnAttacks[chessqdl::nBlack][chessqdl::h7] == (1L << chessqdl::g6), "pawn table is built at compile time");
+
+	for (int idx = 0; idx < 64; idx++) {
+		chessqdl::BitbArray bitboard{};
+		bitboard[chessqdl::nWhite].set(idx);
+		bitboard[chessqdl::nColor].set(idx);
+		bitboard[chessqdl::nKnight].set(idx);
+		bitboard[chessqdl::nKing].set(idx);
+
+		EXPECT_EQ(chessqdl::knightAttacks[idx], chessqdl::MoveGenerator::getKnightMoves(bitboard, chessqdl::nWhite));
+		EXPECT_EQ(chessqdl::kingAttacks[idx], chessqdl::MoveGenerator::getKingMoves(bitboard, chessqdl::nWhite));
+	}
+}
+
+TEST(MoveGenerator, LegalMovesCount_Test) {
+	EXPECT_EQ(chessqdl::MoveGenerator::getLegalMoves(chessqdl::Bitboard()).size(), 20);
+	EXPECT_EQ(chessqdl::MoveGenerator::getLegalMoves(chessqdl::Bitboard("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1")).size(), 48);
+	EXPECT_EQ(chessqdl::MoveGenerator::getLegalMoves(chessqdl::Bitboard("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1")).size(), 14);
+	EXPECT_EQ(chessqdl::MoveGenerator::getLegalMoves(chessqdl::Bitboard("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1")).size(), 6);
+	EXPECT_EQ(chessqdl::MoveGenerator::getLegalMoves(chessqdl::Bitboard("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8")).size(), 44);
+}
+
+TEST(MoveGenerator, LegalSpecialMoves_Test) {
+	// En passant would remove both pawns from the fifth rank and expose the king to the rook
+	auto moves = toStrings(chessqdl::MoveGenerator::getLegalMoves(chessqdl::Bitboard("8/8/8/KPp4r/8/8/8/7k w - c6 0 1")));
+	EXPECT_THAT(moves, testing::Not(testing::Contains("b5c6")));
+	moves = toStrings(chessqdl::MoveGenerator::getLegalMoves(chessqdl::Bitboard("8/8/8/1Pp4r/8/K7/8/7k w - c6 0 1")));
+	EXPECT_THAT(moves, testing::Contains("b5c6"));
+
+	// Castling is not allowed through an attacked square, nor while in check
+	moves = toStrings(chessqdl::MoveGenerator::getLegalMoves(chessqdl::Bitboard("4k3/8/8/8/8/8/6r1/R3K2R w KQ - 0 1")));
+	EXPECT_THAT(moves, testing::Contains("e1c1"));
+	EXPECT_THAT(moves, testing::Not(testing::Contains("e1g1")));
+	moves = toStrings(chessqdl::MoveGenerator::getLegalMoves(chessqdl::Bitboard("4k3/8/8/8/8/8/4r3/R3K2R w KQ - 0 1")));
+	EXPECT_THAT(moves, testing::Not(testing::Contains("e1c1")));
+	EXPECT_THAT(moves, testing::Not(testing::Contains("e1g1")));
+
+	// A pinned piece can only move along the pin
+	moves = toStrings(chessqdl::MoveGenerator::getLegalMoves(chessqdl::Bitboard("4k3/4r3/8/8/8/8/4R3/4K3 w - - 0 1")));
+	EXPECT_THAT(moves, testing::IsSupersetOf({"e2e3", "e2e7"}));
+	EXPECT_THAT(moves, testing::Not(testing::Contains("e2d2")));
+
+	// Checkmate and stalemate
+	chessqdl::Bitboard mate("R5k1/5ppp/8/8/8/8/8/6K1 b - - 0 1");
+	EXPECT_TRUE(chessqdl::MoveGenerator::getLegalMoves(mate).empty());
+	EXPECT_TRUE(chessqdl::MoveGenerator::getCheckers(mate).any());
+	chessqdl::Bitboard stalemate("7k/5Q2/8/8/8/8/8/6K1 b - - 0 1");
+	EXPECT_TRUE(chessqdl::MoveGenerator::getLegalMoves(stalemate).empty());
+	EXPECT_TRUE(chessqdl::MoveGenerator::getCheckers(stalemate).none());
+}
+
+/**
+ * @brief Counts the leaf nodes of the legal move tree up to \p depth
+ */
+static long countLeaves(chessqdl::Bitboard &board, int depth) {
+	chessqdl::MoveList moves;
+	chessqdl::MoveGenerator::getLegalMoves(board, moves);
+
+	if (depth == 1)
+		return moves.size();
+
+	long nodes = 0;
+	for (auto mv : moves) {
+		board.doMove(mv);
+		nodes += countLeaves(board, depth - 1);
+		board.undoMove();
+	}
+	return nodes;
+}
+
+TEST(MoveGenerator, LegalMovesTree_Test) {
+	chessqdl::Bitboard initial;
+	EXPECT_EQ(countLeaves(initial, 3), 8902);
+
+	chessqdl::Bitboard kiwipete("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+	EXPECT_EQ(countLeaves(kiwipete, 3), 97862);
+
+	chessqdl::Bitboard endgame("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1");
+	EXPECT_EQ(countLeaves(endgame, 4), 43238);
+
+	chessqdl::Bitboard promotions("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1");
+	EXPECT_EQ(countLeaves(promotions, 3), 9467);
+
+	chessqdl::Bitboard position5("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8");
+	EXPECT_EQ(countLeaves(position5, 3), 62379);
+}
+
+TEST(MoveGenerator, MovePickerOrder_Test) {
+	chessqdl::Bitboard kiwipete("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+	chessqdl::Move ttMove(chessqdl::e2, chessqdl::a6, chessqdl::fCapture);
+	chessqdl::Move killer(chessqdl::a2, chessqdl::a3, chessqdl::fQuiet);
+	chessqdl::Move illegalKiller(chessqdl::a2, chessqdl::a5, chessqdl::fQuiet);
+
+	chessqdl::MovePicker picker(kiwipete, ttMove, illegalKiller, killer);
+	std::vector<chessqdl::Move> picked;
+	for (auto mv = picker.nextMove(); mv.isValid(); mv = picker.nextMove())
+		picked.push_back(mv);
+
+	// Every legal move is handed out exactly once
+	auto legal = toStrings(chessqdl::MoveGenerator::getLegalMoves(kiwipete));
+	EXPECT_THAT(toStrings(picked), testing::UnorderedElementsAreArray(legal));
+
+	// Transposition table move first, then the captures that do not lose material, then the killer and the quiet moves, and the losing captures last (the smallest loss first)
+	ASSERT_EQ(picked.size(), 48);
+	EXPECT_EQ(picked[0], ttMove);
+	EXPECT_TRUE(picked[1].isCapture());
+	int firstQuiet = std::find_if(picked.begin(), picked.end(), [](chessqdl::Move mv) { return !mv.isCapture(); }) - picked.begin();
+	int firstBad = std::find_if(picked.begin() + firstQuiet, picked.end(), [](chessqdl::Move mv) { return mv.isCapture(); }) - picked.begin();
+	EXPECT_EQ(picked[firstQuiet], killer);
+	EXPECT_TRUE(std::all_of(picked.begin() + 1, picked.begin() + firstQuiet, [&](chessqdl::Move mv) { return chessqdl::MoveGenerator::seeGE(kiwipete, mv); }));
+	EXPECT_TRUE(std::none_of(picked.begin() + firstQuiet, picked.begin() + firstBad, [](chessqdl::Move mv) { return mv.isCapture(); }));
+	ASSERT_LT(firstBad, picked.size());
+	EXPECT_TRUE(std::is_sorted(picked.begin() + firstBad, picked.end(), [&](chessqdl::Move a, chessqdl::Move b) {
+		return chessqdl::MoveGenerator::see(kiwipete, a) > chessqdl::MoveGenerator::see(kiwipete, b);
+	}));
+	EXPECT_EQ(picked.back().toString(), "f3f6");
+	EXPECT_TRUE(std::none_of(picked.begin() + firstBad, picked.end(), [&](chessqdl::Move mv) { return chessqdl::MoveGenerator::seeGE(kiwipete, mv); }));
+
+	// In check, the evasions are generated at once
+	chessqdl::Bitboard check("4k3/8/8/8/8/8/4r3/R3K2R w KQ - 0 1");
+	chessqdl::MovePicker evasions(check, chessqdl::Move());
+	std::vector<chessqdl::Move> evasionMoves;
+	for (auto mv = evasions.nextMove(); mv.isValid(); mv = evasions.nextMove())
+		evasionMoves.push_back(mv);
+	EXPECT_THAT(toStrings(evasionMoves), testing::UnorderedElementsAreArray(toStrings(chessqdl::MoveGenerator::getLegalMoves(check))));
+	EXPECT_EQ(evasionMoves[0].toString(), "e1e2");
+}
+
+TEST(MoveGenerator, MoveHistory_Test) {
+	chessqdl::MoveHistory history;
+	chessqdl::Move best(chessqdl::g1, chessqdl::f3, chessqdl::fQuiet);
+	chessqdl::Move worse(chessqdl::b1, chessqdl::c3, chessqdl::fQuiet);
+	chessqdl::Move previous(chessqdl::e7, chessqdl::e5, chessqdl::fDoublePush);
+
+	chessqdl::MoveList tried;
+	tried.push_back(worse);
+	history.update(chessqdl::nWhite, best, tried, 4, previous);
+
+	EXPECT_EQ(history.getScore(chessqdl::nWhite, best), 16);
+	EXPECT_EQ(history.getScore(chessqdl::nWhite, worse), -16);
+	EXPECT_EQ(history.getScore(chessqdl::nBlack, best), 0);
+	EXPECT_EQ(history.getCounterMove(previous), best);
+
+	history.age();
+	EXPECT_EQ(history.getScore(chessqdl::nWhite, best), 8);
+
+	// Scores saturate instead of growing without bound
+	for (int i = 0; i < 1000; i++)
+		history.update(chessqdl::nWhite, best, chessqdl::MoveList(), 30, previous);
+	EXPECT_LE(history.getScore(chessqdl::nWhite, best), chessqdl::MoveHistory::maxScore);
+
+	// The countermove is handed out right after the killers, and the other quiet moves by history score
+	chessqdl::Bitboard board;
+	board.doMove(chessqdl::Move(chessqdl::e2, chessqdl::e4, chessqdl::fDoublePush));
+	history.clear();
+	chessqdl::Move counter(chessqdl::b8, chessqdl::c6, chessqdl::fQuiet);
+	chessqdl::Move good(chessqdl::h7, chessqdl::h6, chessqdl::fQuiet);
+	history.update(chessqdl::nWhite, counter, chessqdl::MoveList(), 2, board.getLastMove());
+	history.update(chessqdl::nBlack, good, chessqdl::MoveList(), 2, chessqdl::Move());
+
+	chessqdl::MovePicker picker(board, chessqdl::Move(), chessqdl::Move(), chessqdl::Move(), &history);
+	EXPECT_EQ(picker.nextMove(), counter);
+	EXPECT_EQ(picker.nextMove(), good);
+
+	std::vector<chessqdl::Move> picked = {counter, good};
+	for (auto mv = picker.nextMove(); mv.isValid(); mv = picker.nextMove())
+		picked.push_back(mv);
+	EXPECT_THAT(toStrings(picked), testing::UnorderedElementsAreArray(toStrings(chessqdl::MoveGenerator::getLegalMoves(board))));
+}
+
+TEST(MoveGenerator, GenerationTypes_Test) {
+	for (auto fen : {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+					 "8/8/8/1Pp4r/8/K7/8/7k w - c6 0 1"}) {
+		chessqdl::Bitboard board(fen);
+		chessqdl::MoveList captures, quiets;
+		chessqdl::MoveGenerator::getLegalMoves(board, captures, chessqdl::gCaptures);
+		chessqdl::MoveGenerator::getLegalMoves(board, quiets, chessqdl::gQuiets);
+
+		auto all = toStrings(captures);
+		auto quietNames = toStrings(quiets);
+		all.insert(all.end(), quietNames.begin(), quietNames.end());
+		EXPECT_THAT(all, testing::UnorderedElementsAreArray(toStrings(chessqdl::MoveGenerator::getLegalMoves(board))));
+
+		for (auto mv : captures)
+			EXPECT_TRUE(mv.isCapture() || mv.isPromotion());
+		for (auto mv : quiets) {
+			EXPECT_FALSE(mv.isCapture() || mv.isPromotion());
+			EXPECT_TRUE(chessqdl::MoveGenerator::isLegal(board, mv));
+		}
+
+		auto legal = chessqdl::MoveGenerator::getLegalMoves(board);
+		for (auto mv : chessqdl::MoveGenerator::getPseudoLegalMoves(board.getBitBoards(), board.getSideToMove()))
+			EXPECT_EQ(chessqdl::MoveGenerator::isLegal(board, mv), legal.contains(mv)) << mv.toString();
+	}
+}
+
+TEST(MoveGenerator, StaticExchangeEvaluation_Test) {
+	using chessqdl::Move;
+
+	// Rook takes an undefended pawn
+	chessqdl::Bitboard board("1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1");
+	EXPECT_TRUE(chessqdl::MoveGenerator::seeGE(board, Move(chessqdl::e1, chessqdl::e5, chessqdl::fCapture), 1));
+	EXPECT_FALSE(chessqdl::MoveGenerator::seeGE(board, Move(chessqdl::e1, chessqdl::e5, chessqdl::fCapture), 2));
+
+	// Knight takes a pawn defended several times: the knight is lost for the pawn
+	board = chessqdl::Bitboard("1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1");
+	EXPECT_TRUE(chessqdl::MoveGenerator::seeGE(board, Move(chessqdl::d3, chessqdl::e5, chessqdl::fCapture), -2));
+	EXPECT_FALSE(chessqdl::MoveGenerator::seeGE(board, Move(chessqdl::d3, chessqdl::e5, chessqdl::fCapture), -1));
+
+	// X-rays: the rook behind the capturing rook decides the exchange
+	board = chessqdl::Bitboard("4k3/3r4/8/3p4/8/8/3R4/6K1 w - - 0 1");
+	EXPECT_FALSE(chessqdl::MoveGenerator::seeGE(board, Move(chessqdl::d2, chessqdl::d5, chessqdl::fCapture)));
+	board = chessqdl::Bitboard("4k3/3r4/8/3p4/8/8/3R4/3R2K1 w - - 0 1");
+	EXPECT_TRUE(chessqdl::MoveGenerator::seeGE(board, Move(chessqdl::d2, chessqdl::d5, chessqdl::fCapture)));
+	board = chessqdl::Bitboard("3rk3/3r4/8/3p4/8/8/3R4/3R2K1 w - - 0 1");
+	EXPECT_FALSE(chessqdl::MoveGenerator::seeGE(board, Move(chessqdl::d2, chessqdl::d5, chessqdl::fCapture)));
+
+	// Quiet move to a square attacked by a pawn
+	board = chessqdl::Bitboard("4k3/8/4p3/8/8/8/8/3QK3 w - - 0 1");
+	EXPECT_FALSE(chessqdl::MoveGenerator::seeGE(board, Move(chessqdl::d1, chessqdl::d5)));
+	EXPECT_TRUE(chessqdl::MoveGenerator::seeGE(board, Move(chessqdl::d1, chessqdl::d4)));
+
+	// Exchange values
+	board = chessqdl::Bitboard("1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1");
+	EXPECT_EQ(chessqdl::MoveGenerator::see(board, Move(chessqdl::e1, chessqdl::e5, chessqdl::fCapture)), 1);
+	board = chessqdl::Bitboard("1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1");
+	EXPECT_EQ(chessqdl::MoveGenerator::see(board, Move(chessqdl::d3, chessqdl::e5, chessqdl::fCapture)), -2);
+	board = chessqdl::Bitboard("3rk3/3r4/8/3p4/8/8/3R4/3R2K1 w - - 0 1");
+	EXPECT_EQ(chessqdl::MoveGenerator::see(board, Move(chessqdl::d2, chessqdl::d5, chessqdl::fCapture)), -4);
+
+	// The king cannot take a defended piece, but takes an undefended one
+	board = chessqdl::Bitboard("4k3/8/8/8/8/3r4/4K3/8 w - - 0 1");
+	EXPECT_EQ(chessqdl::MoveGenerator::see(board, Move(chessqdl::e2, chessqdl::d3, chessqdl::fCapture)), 5);
+	board = chessqdl::Bitboard("4k3/8/8/8/8/1b1r4/4K3/3R4 b - - 0 1");
+	EXPECT_EQ(chessqdl::MoveGenerator::see(board, Move(chessqdl::d3, chessqdl::d1, chessqdl::fCapture)), 5);
+
+	// Both routines agree on every move and threshold
+	for (auto fen : {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+					 "1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1"}) {
+		board = chessqdl::Bitboard(fen);
+		for (Move mv : chessqdl::MoveGenerator::getLegalMoves(board)) {
+			int value = chessqdl::MoveGenerator::see(board, mv);
+			for (int threshold = -10; threshold <= 10; threshold++)
+				EXPECT_EQ(chessqdl::MoveGenerator::seeGE(board, mv, threshold), value >= threshold) << fen << " " << mv.toString() << " " << threshold;
+		}
+	}
+}
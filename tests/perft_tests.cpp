@@ -0,0 +1,100 @@
+#include "gtest/gtest.h"
+
+#include "Engine/perft.hpp"
+#include "Engine/movegen.hpp"
+
+/**
+ * @brief Published perft counts of positions that exercise castling, en passant, promotions, pins and checks
+ * @ref https://www.chessprogramming.org/Perft_Results
+ */
+TEST(Perft, KnownPositions_Test) {
+	chessqdl::Bitboard initial;
+	EXPECT_EQ(chessqdl::Perft::perft(initial, -1), 0u);
+	EXPECT_EQ(chessqdl::Perft::perft(initial, 0), 1u);
+	EXPECT_EQ(chessqdl::Perft::perft(initial, 1), 20u);
+	EXPECT_EQ(chessqdl::Perft::perft(initial, 2), 400u);
+	EXPECT_EQ(chessqdl::Perft::perft(initial, 4), 197281u);
+
+	chessqdl::Bitboard kiwipete("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+	EXPECT_EQ(chessqdl::Perft::perft(kiwipete, 3), 97862u);
+
+	chessqdl::Bitboard endgame("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1");
+	EXPECT_EQ(chessqdl::Perft::perft(endgame, 5), 674624u);
+
+	chessqdl::Bitboard promotions("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1");
+	EXPECT_EQ(chessqdl::Perft::perft(promotions, 4), 422333u);
+
+	chessqdl::Bitboard position5("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8");
+	EXPECT_EQ(chessqdl::Perft::perft(position5, 3), 62379u);
+
+	// The board is left as it was
+	EXPECT_EQ(position5.getKey(), chessqdl::Bitboard("rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8").getKey());
+}
+
+TEST(Perft, Divide_Test) {
+	chessqdl::Bitboard kiwipete("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+	auto counts = chessqdl::Perft::divide(kiwipete, 3);
+
+	// One entry per legal move, adding up to the perft count
+	EXPECT_EQ(int(counts.size()), chessqdl::MoveGenerator::getLegalMoves(kiwipete).size());
+	uint64_t total = 0;
+	for (const auto &[mv, count] : counts)
+		total += count;
+	EXPECT_EQ(total, 97862u);
+
+	// Published divide counts of two moves
+	auto countOf = [&counts](const std::string &mv) {
+		for (const auto &[m, count] : counts)
+			if (m.toString() == mv)
+				return count;
+		return uint64_t(0);
+	};
+	EXPECT_EQ(countOf("e1g1"), 2059u);
+	EXPECT_EQ(countOf("e2a6"), 1907u);
+}
+
+TEST(Perft, PerftTable_Test) {
+	chessqdl::PerftTable table(1);
+	uint64_t nodes = 0;
+
+	EXPECT_FALSE(table.probe(0x123456789abcdef0, 3, nodes));
+
+	table.store(0x123456789abcdef0, 3, 97862);
+	EXPECT_TRUE(table.probe(0x123456789abcdef0, 3, nodes));
+	EXPECT_EQ(nodes, 97862u);
+
+	// Counts are only found for the same key and depth
+	EXPECT_FALSE(table.probe(0x123456789abcdef0, 4, nodes));
+	EXPECT_FALSE(table.probe(0x123456789abcdef1, 3, nodes));
+
+	// Empty subtrees (mate or stalemate below the root) are stored as well
+	table.store(0x0fedcba987654321, 2, 0);
+	EXPECT_TRUE(table.probe(0x0fedcba987654321, 2, nodes));
+	EXPECT_EQ(nodes, 0u);
+}
+
+TEST(Perft, ParallelHashedDivide_Test) {
+	const std::pair<std::string, int> positions[] = {
+			{"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 4},
+			{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 3},
+			{"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5},
+			{"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4},
+			{"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 3}
+	};
+
+	// The counts of every root move match the single threaded divide, with any number of threads, with or without a table, and with a table so small that entries are replaced all the time
+	for (const auto &[fen, depth] : positions) {
+		chessqdl::Bitboard board(fen);
+		auto expected = chessqdl::Perft::divide(board, depth);
+
+		for (int threads : {1, 3}) {
+			chessqdl::PerftTable table(16), tiny(0);
+			EXPECT_EQ(chessqdl::Perft::divide(board, depth, threads, nullptr), expected) << fen;
+			EXPECT_EQ(chessqdl::Perft::divide(board, depth, threads, &table), expected) << fen;
+			EXPECT_EQ(chessqdl::Perft::divide(board, depth, threads, &tiny), expected) << fen;
+
+			// The table is reused by a second count
+			EXPECT_EQ(chessqdl::Perft::divide(board, depth, threads, &table), expected) << fen;
+		}
+	}
+}
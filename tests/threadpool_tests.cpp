@@ -0,0 +1,26 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "Engine/threadpool.hpp"
+
+TEST(ThreadPool, RunsEveryTask_Test) {
+	chessqdl::ThreadPool pool(4);
+
+	// Every task runs exactly once, batch after batch, even when some tasks are much slower than the others
+	for (int batch = 0; batch < 20; batch++) {
+		std::vector<std::atomic<int>> runs(50);
+		pool.run(runs.size(), [&](int task) {
+			if (task % 7 == 0)
+				std::this_thread::sleep_for(std::chrono::microseconds(200));
+			runs[task]++;
+		});
+		for (auto &count : runs)
+			EXPECT_EQ(count.load(), 1);
+	}
+
+	pool.run(0, [](int) { FAIL(); });
+}
@@ -0,0 +1,108 @@
+#include "gtest/gtest.h"
+#include "Engine/tt.hpp"
+#include "Engine/const.hpp"
+
+#include <thread>
+#include <vector>
+
+TEST(TranspositionTable, StoreProbe_Test) {
+	chessqdl::TranspositionTable tt(1);
+	chessqdl::TTEntry entry{};
+	chessqdl::Move mv(chessqdl::e2, chessqdl::e4, chessqdl::fDoublePush);
+
+	EXPECT_FALSE(tt.probe(0x1234, entry));
+
+	tt.store(0x1234, 5, chessqdl::bLower, -42, mv);
+	ASSERT_TRUE(tt.probe(0x1234, entry));
+	EXPECT_EQ(entry.move, mv);
+	EXPECT_EQ(entry.score, -42);
+	EXPECT_EQ(entry.depth, 5);
+	EXPECT_EQ(entry.bound, chessqdl::bLower);
+
+	// Storing the same position without a move keeps the previous move
+	tt.store(0x1234, 6, chessqdl::bUpper, 7, chessqdl::Move());
+	ASSERT_TRUE(tt.probe(0x1234, entry));
+	EXPECT_EQ(entry.move, mv);
+	EXPECT_EQ(entry.depth, 6);
+
+	tt.clear();
+	EXPECT_FALSE(tt.probe(0x1234, entry));
+}
+
+TEST(TranspositionTable, OnlyCurrentSearch_Test) {
+	chessqdl::TranspositionTable shared(1), isolated(1, true);
+	chessqdl::TTEntry entry{};
+	chessqdl::Move mv(chessqdl::e2, chessqdl::e4, chessqdl::fDoublePush);
+
+	shared.store(0x1234, 5, chessqdl::bLower, -42, mv);
+	isolated.store(0x1234, 5, chessqdl::bLower, -42, mv);
+
+	// A new search keeps the entries of a shared table, but empties a table that only keeps the current search
+	shared.newSearch();
+	isolated.newSearch();
+	EXPECT_TRUE(shared.probe(0x1234, entry));
+	EXPECT_FALSE(isolated.probe(0x1234, entry));
+
+	// The old entry is not merged with a new one of the same position
+	isolated.store(0x1234, 3, chessqdl::bUpper, 7, chessqdl::Move());
+	ASSERT_TRUE(isolated.probe(0x1234, entry));
+	EXPECT_FALSE(entry.move.isValid());
+
+	// Entries written 64 searches ago are not taken as current when the generations wrap around
+	for (int i = 0; i < 64; i++)
+		isolated.newSearch();
+	EXPECT_FALSE(isolated.probe(0x1234, entry));
+}
+
+TEST(TranspositionTable, Replacement_Test) {
+	chessqdl::TranspositionTable tt(1);
+	chessqdl::TTEntry entry{};
+	uint64_t buckets = 1024 * 1024 / 64;
+
+	// Five positions that share a bucket of four entries: the shallowest one is replaced
+	for (uint64_t i = 0; i < 4; i++)
+		tt.store(i * buckets + 1, 10 + int(i), chessqdl::bExact, 0, chessqdl::Move());
+	tt.store(4 * buckets + 1, 3, chessqdl::bExact, 0, chessqdl::Move());
+
+	EXPECT_FALSE(tt.probe(1, entry));
+	for (uint64_t i = 1; i < 5; i++)
+		EXPECT_TRUE(tt.probe(i * buckets + 1, entry));
+
+	// Entries from older searches are replaced before deeper ones
+	for (int i = 0; i < 8; i++)
+		tt.newSearch();
+	tt.store(5 * buckets + 1, 1, chessqdl::bExact, 0, chessqdl::Move());
+	EXPECT_TRUE(tt.probe(5 * buckets + 1, entry));
+	EXPECT_TRUE(tt.probe(3 * buckets + 1, entry));
+}
+
+TEST(TranspositionTable, MateScores_Test) {
+	int mateIn3 = chessqdl::scoreMate - 5;
+	EXPECT_EQ(chessqdl::TranspositionTable::scoreToTT(mateIn3, 4), chessqdl::scoreMate - 1);
+	EXPECT_EQ(chessqdl::TranspositionTable::scoreFromTT(chessqdl::scoreMate - 1, 2), chessqdl::scoreMate - 3);
+	EXPECT_EQ(chessqdl::TranspositionTable::scoreToTT(-mateIn3, 4), -chessqdl::scoreMate + 1);
+	EXPECT_EQ(chessqdl::TranspositionTable::scoreToTT(150, 4), 150);
+}
+
+TEST(TranspositionTable, ConcurrentAccess_Test) {
+	chessqdl::TranspositionTable tt(1);
+	std::vector<std::thread> threads;
+
+	// Every thread writes entries whose content is derived from the key, so any entry accepted by probe must be consistent
+	for (int t = 0; t < 4; t++) {
+		threads.emplace_back([&tt, t] {
+			chessqdl::TTEntry entry{};
+			for (uint64_t i = 0; i < 20000; i++) {
+				uint64_t key = (i * 0x9e3779b97f4a7c15ULL) ^ (t & 1);
+				tt.store(key, int(key % 64), chessqdl::bExact, int(key % 1000), chessqdl::Move(int(key % 64), int((key >> 6) % 64)));
+				if (tt.probe(key ^ 1, entry)) {
+					EXPECT_EQ(entry.depth, int((key ^ 1) % 64));
+					EXPECT_EQ(entry.score, int((key ^ 1) % 1000));
+				}
+			}
+		});
+	}
+
+	for (auto &thread : threads)
+		thread.join();
+}